@@ -66,7 +66,12 @@ cd ../..
 echo "Testing AccelerationSceneReducedTSID ..."
 cd acceleration_reduced_tsid/test
 ./test_acceleration_scene_reduced_tsid
-cd ../../..
+cd ../..
+
+echo "Testing scene allocations ..."
+cd test
+./test_scene_allocations
+cd ../..
 
 # Solvers
 echo "Testing hls ..."
@@ -74,6 +79,16 @@ cd solvers/hls/test
 ./test_hls_solver  
 cd ../..
 
+echo "Testing HierarchicalQPSolver ..."
+cd hqp/test
+./test_hqp_solver
+cd ../..
+
+echo "Testing FallbackSolver ..."
+cd fallback/test
+./test_fallback_solver
+cd ../..
+
 echo "Testing QPOasesSolver ..."
 cd qpoases/test
 ./test_qpoases_solver
@@ -90,6 +105,12 @@ if [ -d "proxqp" ]; then
   ./test_proxqp_solver
   cd ../..
 fi
+if [ -d "proxqp_sparse" ]; then
+  echo "Testing ProxQPSparseSolver ..."
+  cd proxqp_sparse/test
+  ./test_proxqp_sparse_solver
+  cd ../..
+fi
 if [ -d "qpswift" ]; then
   echo "Testing QPSwiftSolver ..."
   cd qpswift/test
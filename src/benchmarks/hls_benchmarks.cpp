@@ -0,0 +1,187 @@
+#include <robot_models/pinocchio/RobotModelPinocchio.hpp>
+#include <solvers/hls/HierarchicalLSSolver.hpp>
+#include <core/QuadraticProgram.hpp>
+#include <core/TimingStats.hpp>
+#include <fstream>
+#include <iostream>
+#include <cmath>
+
+using namespace std;
+using namespace wbc;
+
+/**
+ * Benchmark of the decompositions of the hierarchical least squares solver (see HLSDecomposition) on task Jacobians of real robots.
+ * For each robot, the Jacobians are computed for a number of joint configurations on a trajectory that passes through the zero
+ * configuration, which is singular for most robots (e.g. stretched arm). For each decomposition, the solver execution time and
+ * the maximum deviation of the solution from the default decomposition (hls_kdl_svd) are written in JSON format. All times are in seconds.
+ *
+ * Usage: hls_benchmarks [n_configurations] [n_cycles] [output_file]
+ *
+ * Default is 100 configurations, 100 solver calls per configuration and output to stdout.
+ */
+
+/** Robot setup: The task Jacobians on each priority level are the stacked space Jacobians of the given (root,tip) frame pairs*/
+struct HLSBenchmarkRobot{
+    std::string name;
+    std::string urdf_file;
+    bool floating_base;
+    std::map<std::string,double> q0;        /** Joint positions at the start of the trajectory, all other joints are set to zero*/
+    std::vector< std::vector< std::pair<std::string,std::string> > > prios;
+};
+
+const std::vector< std::pair<std::string,HLSDecomposition> > decompositions = {
+    {"kdl_svd",    hls_kdl_svd},
+    {"jacobi_svd", hls_jacobi_svd},
+    {"bdc_svd",    hls_bdc_svd},
+    {"ldlt",       hls_ldlt}
+};
+
+std::vector<HLSBenchmarkRobot> makeRobots(const std::string& models_dir){
+
+    std::vector<HLSBenchmarkRobot> robots(3);
+
+    HLSBenchmarkRobot& kuka = robots[0];
+    kuka.name = "kuka_iiwa";
+    kuka.urdf_file = models_dir + "/kuka/urdf/kuka_iiwa.urdf";
+    kuka.floating_base = false;
+    kuka.q0 = {{"kuka_lbr_l_joint_2", 0.5}, {"kuka_lbr_l_joint_4", -1.2}, {"kuka_lbr_l_joint_6", 0.8}};
+    kuka.prios = {{{"kuka_lbr_l_link_0", "kuka_lbr_l_tcp"}}};
+
+    HLSBenchmarkRobot& rh5v2 = robots[1];
+    rh5v2.name = "rh5v2";
+    rh5v2.urdf_file = models_dir + "/rh5v2/urdf/rh5v2.urdf";
+    rh5v2.floating_base = false;
+    rh5v2.q0 = {{"ALShoulder1", -1.0}, {"ALShoulder2", 1.0}, {"ALElbow", -1.0},
+                {"ARShoulder1", -1.0}, {"ARShoulder2", 1.0}, {"ARElbow", -1.0}};
+    rh5v2.prios = {{{"RH5v2_Root_Link", "ALWristFT_Link"}},
+                   {{"RH5v2_Root_Link", "ARWristFT_Link"}}};
+
+    HLSBenchmarkRobot& rh5 = robots[2];
+    rh5.name = "rh5";
+    rh5.urdf_file = models_dir + "/rh5/urdf/rh5.urdf";
+    rh5.floating_base = true;
+    rh5.q0 = {{"LLHip3", -0.35}, {"LLKnee", 0.64}, {"LLAnklePitch", -0.27},
+              {"LRHip3", -0.35}, {"LRKnee", 0.64}, {"LRAnklePitch", -0.27},
+              {"ALShoulder1", -1.0}, {"ALElbow", -1.0}, {"ARShoulder1", -1.0}, {"ARElbow", -1.0}};
+    rh5.prios = {{{"world", "FL_SupportCenter"}, {"world", "FR_SupportCenter"}},
+                 {{"world", "RH5_Root_Link"}},
+                 {{"RH5_Root_Link", "AL_TCP_Link"}, {"RH5_Root_Link", "AR_TCP_Link"}}};
+
+    return robots;
+}
+
+/** Compute the hierarchical problems for n_configurations joint configurations of the given robot*/
+std::vector<HierarchicalQP> makeProblems(const HLSBenchmarkRobot& robot, uint n_configurations){
+
+    RobotModelPinocchio robot_model;
+    if(!robot_model.configure(RobotModelConfig(robot.urdf_file, robot.floating_base)))
+        throw std::runtime_error("Failed to configure robot model");
+
+    base::samples::Joints joint_state;
+    joint_state.names = robot_model.actuatedJointNames();
+    joint_state.resize(joint_state.names.size());
+    base::samples::RigidBodyStateSE3 fb_state;
+    fb_state.pose.position.setZero();
+    fb_state.pose.orientation.setIdentity();
+    fb_state.twist.setZero();
+    fb_state.acceleration.setZero();
+
+    std::vector<HierarchicalQP> problems(n_configurations);
+    for(uint k = 0; k < n_configurations; k++){
+
+        // Move from q0 to -q0 and back, passing the zero configuration
+        for(size_t i = 0; i < joint_state.size(); i++){
+            auto it = robot.q0.find(joint_state.names[i]);
+            joint_state[i].position = (it == robot.q0.end() ? 0 : it->second) * cos(2*M_PI*k/n_configurations);
+            joint_state[i].speed = joint_state[i].acceleration = 0;
+        }
+        joint_state.time = fb_state.time = base::Time::now();
+        robot_model.update(joint_state, fb_state);
+
+        HierarchicalQP& hqp = problems[k];
+        hqp.Wq.setOnes(robot_model.noOfJoints());
+        for(const auto& frames : robot.prios){
+            QuadraticProgram qp;
+            qp.resize(robot_model.noOfJoints(), 6*frames.size(), 0, false);
+            for(size_t i = 0; i < frames.size(); i++)
+                qp.A.middleRows(6*i,6) = robot_model.spaceJacobian(frames[i].first, frames[i].second);
+            for(uint i = 0; i < qp.b.size(); i++)
+                qp.b[i] = 0.1*sin(i + 0.1*k);
+            hqp << qp;
+        }
+    }
+    return problems;
+}
+
+int main(int argc, char** argv){
+
+    uint n_configurations = 100, n_cycles = 100;
+    if(argc > 1)
+        n_configurations = std::stoi(argv[1]);
+    if(argc > 2)
+        n_cycles = std::stoi(argv[2]);
+    if(n_configurations == 0 || n_cycles == 0){
+        std::cerr << "Number of configurations and number of cycles have to be > 0" << std::endl;
+        return -1;
+    }
+    std::ofstream out_file;
+    if(argc > 3){
+        out_file.open(argv[3]);
+        if(!out_file.is_open()){
+            std::cerr << "Unable to open output file " << argv[3] << std::endl;
+            return -1;
+        }
+    }
+    std::ostream& out = argc > 3 ? out_file : std::cout;
+    out.precision(9);
+
+    out << "[" << std::endl;
+    bool first = true;
+    for(const HLSBenchmarkRobot& robot : makeRobots(WBC_MODELS_DIR)){
+
+        std::cerr << "Running " << robot.name << std::endl;
+        std::vector<HierarchicalQP> problems = makeProblems(robot, n_configurations);
+        std::vector<int> n_constraints_per_prio;
+        for(const QuadraticProgram& qp : problems[0].prios)
+            n_constraints_per_prio.push_back(qp.A.rows());
+        const uint n_joints = problems[0].Wq.size();
+
+        // Reference solutions
+        std::vector<base::VectorXd> reference(problems.size());
+        HierarchicalLSSolver reference_solver;
+        reference_solver.configure(n_constraints_per_prio, n_joints);
+        for(size_t k = 0; k < problems.size(); k++)
+            reference_solver.solve(problems[k], reference[k]);
+
+        for(const auto& decomposition : decompositions){
+            HierarchicalLSSolver solver;
+            solver.configure(n_constraints_per_prio, n_joints);
+            solver.setDecomposition(decomposition.second);
+
+            TimingStats stats(n_configurations*n_cycles);
+            base::VectorXd solver_output;
+            double max_error = 0;
+            for(size_t k = 0; k < problems.size(); k++){
+                for(uint i = 0; i < n_cycles; i++){
+                    TimingStats::Clock::time_point start = TimingStats::Clock::now();
+                    solver.solve(problems[k], solver_output);
+                    stats.add(start);
+                }
+                max_error = std::max(max_error, (solver_output - reference[k]).cwiseAbs().maxCoeff());
+            }
+
+            if(!first)
+                out << "," << std::endl;
+            first = false;
+            out << "{\"robot\": \"" << robot.name << "\", \"n_joints\": " << n_joints << ", \"n_constraints_per_prio\": [";
+            for(size_t i = 0; i < n_constraints_per_prio.size(); i++)
+                out << (i > 0 ? ", " : "") << n_constraints_per_prio[i];
+            out << "], \"decomposition\": \"" << decomposition.first << "\", \"n_samples\": " << stats.n_samples
+                << ", \"min\": " << stats.min << ", \"mean\": " << stats.mean << ", \"p99\": " << stats.p99() << ", \"max\": " << stats.max
+                << ", \"max_error\": " << max_error << "}";
+        }
+    }
+    out << std::endl << "]" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,249 @@
+#include <core/RobotModel.hpp>
+#include <core/QPSolver.hpp>
+#include <core/Scene.hpp>
+#include <fstream>
+#include <iostream>
+#include <cmath>
+
+using namespace std;
+using namespace wbc;
+
+/**
+ * Benchmark of the full WBC pipeline (robot model update, scene update, solve) for all registered robot models and all
+ * meaningful scene/solver combinations. For each combination, the per-stage execution times as recorded by the scene
+ * (see Scene::getTimingStats()) are written in JSON format, together with the execution time of the robot model update and of the
+ * complete cycle. All times are in seconds.
+ *
+ * Usage: wbc_benchmarks [n_cycles] [output_file]
+ *
+ * Default is 1000 cycles per combination and output to stdout.
+ */
+
+/** Robot setup for the benchmark: Robot model configuration, initial joint state and task configuration*/
+struct BenchmarkRobot{
+    std::string name;
+    std::string urdf_file;
+    std::string submechanism_file;              /** Only used by the hyrodyn robot model*/
+    bool floating_base;
+    ActiveContacts contacts;
+    std::map<std::string,double> q0;            /** Initial joint positions, all other joints are set to zero*/
+    base::Vector3d fb_position;                 /** Initial floating base position (only floating base robots)*/
+    std::vector<TaskConfig> tasks;
+};
+
+/** Scene/solver combinations. The velocity scene formulates all tasks as equality constraints and requires the hls solver,
+ *  all other scenes build a QP with hard constraints*/
+const std::vector< std::pair<std::string, std::vector<std::string> > > scene_solver_pairs = {
+    {"velocity",                  {"hls"}},
+    {"velocity_qp",               {"qpoases", "proxqp", "eiquadprog", "qpswift"}},
+    {"acceleration",              {"qpoases", "proxqp", "eiquadprog", "qpswift"}},
+    {"acceleration_tsid",         {"qpoases", "proxqp", "proxqp_sparse", "eiquadprog", "qpswift"}},
+    {"acceleration_reduced_tsid", {"qpoases", "proxqp", "proxqp_sparse", "eiquadprog", "qpswift"}}
+};
+
+std::vector<BenchmarkRobot> makeRobots(const std::string& models_dir){
+
+    std::vector<BenchmarkRobot> robots(3);
+
+    BenchmarkRobot& kuka = robots[0];
+    kuka.name = "kuka_iiwa";
+    kuka.urdf_file = models_dir + "/kuka/urdf/kuka_iiwa.urdf";
+    kuka.submechanism_file = models_dir + "/kuka/hyrodyn/kuka_iiwa.yml";
+    kuka.floating_base = false;
+    kuka.fb_position.setZero();
+    kuka.q0 = {{"kuka_lbr_l_joint_2", 0.5}, {"kuka_lbr_l_joint_4", -1.2}, {"kuka_lbr_l_joint_6", 0.8}};
+    kuka.tasks = {TaskConfig("cart_pos_ctrl", 0, "kuka_lbr_l_link_0", "kuka_lbr_l_tcp", "kuka_lbr_l_link_0", 1.0)};
+
+    BenchmarkRobot& rh5_legs = robots[1];
+    rh5_legs.name = "rh5_legs";
+    rh5_legs.urdf_file = models_dir + "/rh5/urdf/rh5_legs.urdf";
+    rh5_legs.submechanism_file = models_dir + "/rh5/hyrodyn/rh5_legs.yml";
+    rh5_legs.floating_base = true;
+    ActiveContact contact(1,0.6);
+    contact.wx = 0.2;
+    contact.wy = 0.08;
+    rh5_legs.contacts.names = {"FL_SupportCenter", "FR_SupportCenter"};
+    rh5_legs.contacts.elements = {contact, contact};
+    rh5_legs.q0 = {{"LLHip3", -0.35}, {"LLKnee", 0.64}, {"LLAnklePitch", -0.27},
+                   {"LRHip3", -0.35}, {"LRKnee", 0.64}, {"LRAnklePitch", -0.27}};
+    rh5_legs.fb_position = base::Vector3d(-0.175,0,0.876);
+    rh5_legs.tasks = {TaskConfig("com_pos_ctrl", 0, "world", "RH5_Root_Link", "world", 1.0)};
+
+    BenchmarkRobot& rh5v2 = robots[2];
+    rh5v2.name = "rh5v2";
+    rh5v2.urdf_file = models_dir + "/rh5v2/urdf/rh5v2.urdf";
+    rh5v2.submechanism_file = models_dir + "/rh5v2/hyrodyn/rh5v2.yml";
+    rh5v2.floating_base = false;
+    rh5v2.fb_position.setZero();
+    rh5v2.q0 = {{"ALShoulder1", -1.0}, {"ALShoulder2", 1.0}, {"ALElbow", -1.0},
+                {"ARShoulder1", -1.0}, {"ARShoulder2", 1.0}, {"ARElbow", -1.0}};
+    rh5v2.tasks = {TaskConfig("cart_ctrl_left",  0, "RH5v2_Root_Link", "ALWristFT_Link", "RH5v2_Root_Link", 1.0),
+                   TaskConfig("cart_ctrl_right", 0, "RH5v2_Root_Link", "ARWristFT_Link", "RH5v2_Root_Link", 1.0)};
+
+    return robots;
+}
+
+std::string jsonString(const std::string& str){
+    std::string escaped;
+    for(char c : str){
+        if(c == '"' || c == '\\')
+            escaped += '\\';
+        if(c == '\n')
+            escaped += "\\n";
+        else
+            escaped += c;
+    }
+    return "\"" + escaped + "\"";
+}
+
+void writeTimingStats(std::ostream& out, const std::string& name, const TimingStats& stats){
+    out << jsonString(name) << ": {\"n_samples\": " << stats.n_samples;
+    // Stages that are not executed in a particular scene have no samples
+    if(stats.n_samples == 0)
+        out << ", \"min\": null, \"mean\": null, \"p99\": null, \"max\": null}";
+    else
+        out << ", \"min\": " << stats.min
+            << ", \"mean\": " << stats.mean
+            << ", \"p99\": " << stats.p99()
+            << ", \"max\": " << stats.max << "}";
+}
+
+/** Run the benchmark for one combination of robot, robot model, scene and solver. Throws if any of the components cannot be configured or fails*/
+void runBenchmark(const BenchmarkRobot& robot, const std::string& robot_model_type, const std::string& scene_type,
+                  const std::string& solver_type, uint n_cycles, TimingStats& robot_model_update, TimingStats& cycle, TimingsStats& scene_stats){
+
+    RobotModelPtr robot_model(RobotModelFactory::createInstance(robot_model_type));
+    RobotModelConfig config(robot.urdf_file, robot.floating_base, robot.contacts);
+    config.type = robot_model_type;
+    if(robot_model_type == "hyrodyn")
+        config.submechanism_file = robot.submechanism_file;
+    if(!robot_model->configure(config))
+        throw std::runtime_error("Failed to configure robot model");
+
+    QPSolverPtr solver(QPSolverFactory::createInstance(solver_type));
+    const double dt = 1e-3;
+    ScenePtr scene(SceneFactory::createInstance(scene_type, robot_model, solver, dt));
+
+    base::samples::Joints joint_state;
+    joint_state.names = robot_model->actuatedJointNames();
+    joint_state.resize(joint_state.names.size());
+    base::VectorXd q0(joint_state.size());
+    for(size_t i = 0; i < joint_state.size(); i++){
+        auto it = robot.q0.find(joint_state.names[i]);
+        q0[i] = it == robot.q0.end() ? 0 : it->second;
+        joint_state[i].position = q0[i];
+        joint_state[i].speed = joint_state[i].acceleration = 0;
+    }
+    base::samples::RigidBodyStateSE3 fb_state;
+    fb_state.pose.position = robot.fb_position;
+    fb_state.pose.orientation.setIdentity();
+    fb_state.twist.setZero();
+    fb_state.acceleration.setZero();
+
+    // The robot model has to be updated once before configuring the scene
+    joint_state.time = fb_state.time = base::Time::now();
+    robot_model->update(joint_state, fb_state);
+    if(!scene->configure(robot.tasks))
+        throw std::runtime_error("Failed to configure scene");
+
+    base::samples::RigidBodyStateSE3 ref;
+    ref.twist.setZero();
+    ref.acceleration.setZero();
+    ref.twist.linear[0] = ref.acceleration.linear[0] = 0.01;
+    for(const TaskConfig& task : robot.tasks)
+        scene->setReference(task.name, ref);
+
+    // Warm up: The first cycle may allocate memory and initialize the solver
+    scene->solve(scene->update());
+    scene->resetTimingStats();
+
+    for(uint k = 0; k < n_cycles; k++){
+
+        // Move the joints slightly, so that the solver does not get the same problem in each cycle
+        for(size_t i = 0; i < joint_state.size(); i++){
+            joint_state[i].position = q0[i] + 0.01*sin(k*dt);
+            joint_state[i].speed = 0.01*cos(k*dt);
+        }
+        joint_state.time = fb_state.time = base::Time::now();
+
+        TimingStats::Clock::time_point start = TimingStats::Clock::now();
+        robot_model->update(joint_state, fb_state);
+        robot_model_update.add(start);
+        scene->solve(scene->update());
+        cycle.add(start);
+    }
+    scene_stats = scene->getTimingStats();
+}
+
+int main(int argc, char** argv){
+
+    uint n_cycles = 1000;
+    if(argc > 1)
+        n_cycles = std::stoi(argv[1]);
+    if(n_cycles == 0){
+        std::cerr << "Number of cycles has to be > 0" << std::endl;
+        return -1;
+    }
+    std::ofstream out_file;
+    if(argc > 2){
+        out_file.open(argv[2]);
+        if(!out_file.is_open()){
+            std::cerr << "Unable to open output file " << argv[2] << std::endl;
+            return -1;
+        }
+    }
+    std::ostream& out = argc > 2 ? out_file : std::cout;
+    out.precision(9);
+
+    std::vector<BenchmarkRobot> robots = makeRobots(WBC_MODELS_DIR);
+
+    out << "[" << std::endl;
+    bool first = true;
+    for(const BenchmarkRobot& robot : robots){
+        for(const auto& rm : *RobotModelFactory::getRobotModelMap()){
+            for(const auto& scene_solvers : scene_solver_pairs){
+                if(SceneFactory::getSceneMap()->count(scene_solvers.first) == 0)
+                    continue;
+                for(const std::string& solver_type : scene_solvers.second){
+                    if(QPSolverFactory::getQPSolverMap()->count(solver_type) == 0)
+                        continue;
+
+                    std::cerr << "Running " << robot.name << " / " << rm.first << " / " << scene_solvers.first << " / " << solver_type << std::endl;
+
+                    TimingStats robot_model_update(n_cycles), cycle(n_cycles);
+                    TimingsStats scene_stats;
+                    std::string error;
+                    try{
+                        runBenchmark(robot, rm.first, scene_solvers.first, solver_type, n_cycles, robot_model_update, cycle, scene_stats);
+                    }
+                    catch(std::exception& e){
+                        error = e.what();
+                        std::cerr << "Benchmark failed: " << error << std::endl;
+                    }
+
+                    if(!first)
+                        out << "," << std::endl;
+                    first = false;
+                    out << "{\"robot\": " << jsonString(robot.name) << ", \"robot_model\": " << jsonString(rm.first) << ", \"scene\": " << jsonString(scene_solvers.first)
+                        << ", \"solver\": " << jsonString(solver_type) << ", \"n_cycles\": " << n_cycles << ", ";
+                    if(!error.empty()){
+                        out << "\"error\": " << jsonString(error) << "}";
+                        continue;
+                    }
+                    out << "\"stages\": {";
+                    writeTimingStats(out, "cycle", cycle);
+                    out << ", ";
+                    writeTimingStats(out, "robot_model_update", robot_model_update);
+                    for(size_t i = 0; i < scene_stats.size(); i++){
+                        out << ", ";
+                        writeTimingStats(out, scene_stats.names[i], scene_stats[i]);
+                    }
+                    out << "}}";
+                }
+            }
+        }
+    }
+    out << std::endl << "]" << std::endl;
+
+    return 0;
+}
@@ -5,6 +5,7 @@ namespace wbc{
     void ContactsAccelerationConstraint::update(RobotModelPtr robot_model) {
         
         const ActiveContacts& contacts = robot_model->getActiveContacts();
+        registerContactChains(robot_model);
 
         uint nj = robot_model->noOfJoints();
         uint na = robot_model->noOfActuatedJoints();
@@ -12,21 +13,16 @@ namespace wbc{
 
         uint nv = reduced ? (nj + nc*6) : (nj + na + nc*6);
 
-        A_mtx.resize(nc*6, nv);
-        b_vec.resize(nc*6);
-
-        A_mtx.setZero();
-        b_vec.setZero();
-
-        for(int i = 0; i < contacts.size(); i++){
-            const base::Acceleration& a = robot_model->spatialAccelerationBias(robot_model->worldFrame(), contacts.names[i]);
-            base::Vector6d acc;
-            acc.segment(0,3) = a.linear;
-            acc.segment(3,3) = a.angular;
-
-            b_vec.segment(i*6, 6) = -acc;
-            A_mtx.block(i*6,  0, 6, nj) = robot_model->spaceJacobian(robot_model->worldFrame(), contacts.names[i]);
+        // Resize only if the problem dimensions change. All entries that are not overwritten below are constant zero
+        if(A_mtx.rows() != nc*6 || A_mtx.cols() != nv){
+            A_mtx.setZero(nc*6, nv);
+            b_vec.setZero(nc*6);
         }
+
+        // Write all contact Jacobians and acceleration biases directly into the constraint matrix/vector
+        robot_model->spaceJacobians(contact_handles, A_mtx.leftCols(nj));
+        robot_model->spatialAccelerationBiases(contact_handles, b_vec);
+        b_vec = -b_vec;
     }
 
 
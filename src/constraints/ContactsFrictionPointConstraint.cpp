@@ -17,13 +17,12 @@ void ContactsFrictionPointConstraint::update(RobotModelPtr robot_model){
     const uint row_skip = use_torques ? 8 : 4;
     const uint col_skip = use_torques ? 6 : 3;
 
-    A_mtx.resize(nc*row_skip, nv);
-    lb_vec.resize(nc*row_skip);
-    ub_vec.resize(nc*row_skip);
-
-    A_mtx.setZero();
-    ub_vec.setZero();
-    lb_vec.setZero();
+    // Resize only if the problem dimensions change. All entries that are not overwritten below are constant zero
+    if(A_mtx.rows() != nc*row_skip || A_mtx.cols() != nv){
+        A_mtx.setZero(nc*row_skip, nv);
+        lb_vec.resize(nc*row_skip);
+        ub_vec.resize(nc*row_skip);
+    }
 
     uint start_idx = reduced ? nj : nj + na;
 
@@ -32,12 +31,12 @@ void ContactsFrictionPointConstraint::update(RobotModelPtr robot_model){
         double mu=contacts[i].mu;
 
         // We assume that contact surface normal is always world_z, TODO: Make this dynamically (re-)configurable
-        Eigen::MatrixXd a(row_skip,col_skip);
+        Eigen::Matrix<double,row_skip,col_skip> a;
         a << 1,0,-mu,
              0,1,-mu,
              1,0, mu,
              0,1, mu;
-        Eigen::VectorXd lb(row_skip), ub(row_skip);
+        Eigen::Matrix<double,row_skip,1> lb, ub;
         lb << -1e10,-1e10,0,0;
         ub << 0,0,1e10,1e10;
 
@@ -14,13 +14,12 @@ void ContactsFrictionSurfaceConstraint::update(RobotModelPtr robot_model){
 
     const uint row_skip = 16, col_skip = 6;
 
-    A_mtx.resize(nc*row_skip, nv);
-    lb_vec.resize(nc*row_skip);
-    ub_vec.resize(nc*row_skip);
-
-    A_mtx.setZero();
-    ub_vec.setZero();
-    lb_vec.setZero();
+    // Resize only if the problem dimensions change. All entries that are not overwritten below are constant
+    if(A_mtx.rows() != nc*row_skip || A_mtx.cols() != nv){
+        A_mtx.setZero(nc*row_skip, nv);
+        lb_vec.setConstant(nc*row_skip, -1e10);
+        ub_vec.setZero(nc*row_skip);
+    }
 
     uint start_idx = reduced ? nj : nj + na;
 
@@ -28,7 +27,7 @@ void ContactsFrictionSurfaceConstraint::update(RobotModelPtr robot_model){
         double mu=contacts[i].mu;
         double wx = contacts[i].wx, wy = contacts[i].wy;
 
-        Eigen::MatrixXd a(row_skip,col_skip);
+        Eigen::Matrix<double,row_skip,col_skip> a;
         a << -1,  0, -mu,  0,  0, 0,
               1,  0, -mu,  0,  0, 0,
               0, -1, -mu,  0,  0, 0,
@@ -46,12 +45,6 @@ void ContactsFrictionSurfaceConstraint::update(RobotModelPtr robot_model){
               -wy,  wx, -(wx+wy)*mu, -mu,  mu,  1,
               -wy, -wx, -(wx+wy)*mu, -mu, -mu,  1;
 
-        Eigen::VectorXd lb(row_skip), ub(row_skip);
-        lb.setConstant(-1e10);
-        ub.setZero();
-
-        lb_vec.segment(i*row_skip,row_skip) = lb;
-        ub_vec.segment(i*row_skip,row_skip) = ub;
         A_mtx.block<row_skip,col_skip>(i*row_skip,start_idx+i*6) = a;
     }
 }
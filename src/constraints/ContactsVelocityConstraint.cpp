@@ -5,16 +5,19 @@ namespace wbc{
     void ContactsVelocityConstraint::update(RobotModelPtr robot_model) {
         
         const ActiveContacts& contacts = robot_model->getActiveContacts();
+        registerContactChains(robot_model);
 
         uint nj = robot_model->noOfJoints();
         uint nc = contacts.size();
 
-        A_mtx.resize(nc*6, nj);
-        b_vec.resize(nc*6);
-        b_vec.setZero();
+        // Resize only if the problem dimensions change. The constraint vector is constant zero
+        if(A_mtx.rows() != nc*6 || A_mtx.cols() != nj){
+            A_mtx.resize(nc*6, nj);
+            b_vec.setZero(nc*6);
+        }
 
         for(int i = 0; i < nc; ++i)
-            A_mtx.block(i*6, 0, 6, nj) = contacts[i].active * robot_model->bodyJacobian(robot_model->worldFrame(), contacts.names[i]);
+            A_mtx.block(i*6, 0, 6, nj) = contacts[i].active * robot_model->bodyJacobian(contact_handles[i]);
     }
 
 
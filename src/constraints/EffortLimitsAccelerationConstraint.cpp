@@ -5,33 +5,36 @@ namespace wbc{
     void EffortLimitsAccelerationConstraint::update(RobotModelPtr robot_model) {
         
         const auto& contacts = robot_model->getActiveContacts();
+        registerContactChains(robot_model);
 
         uint nj = robot_model->noOfJoints();
         uint na = robot_model->noOfActuatedJoints();
         uint nc = contacts.size();
 
-        lb_vec.resize(na);
-        ub_vec.resize(na);
+        updateJointIndices(robot_model);
 
-        lb_vec.setConstant(-10000);
-        ub_vec.setConstant(+10000);
-        
-        A_mtx.resize(na, nj+6*nc);
-        A_mtx.setZero();
+        // Resize only if the problem dimensions change. All entries that are not overwritten below are constant zero
+        if(A_mtx.rows() != na || A_mtx.cols() != nj+6*nc){
+            lb_vec.resize(na);
+            ub_vec.resize(na);
+            A_mtx.setZero(na, nj+6*nc);
+        }
 
         //! NOTE! -> not considering selection matrix
 
         A_mtx.block(0,0,na,nj) = robot_model->jointSpaceInertiaMatrix().bottomRows(na);
-        for(uint i=0; i < nc; ++i)
-            A_mtx.block(0,nj+i*6,na,6) = -robot_model->bodyJacobian(robot_model->worldFrame(), contacts.names[i]).transpose().bottomRows(na);
+        if(contact_jacobians.rows() != nc*6 || contact_jacobians.cols() != nj)
+            contact_jacobians.resize(nc*6, nj);
+        robot_model->bodyJacobians(contact_handles, contact_jacobians);
+        A_mtx.block(0,nj,na,nc*6) = -contact_jacobians.rightCols(na).transpose();
 
         // enforce joint effort limits (only if torques are part of the optimization problem)
-        Eigen::VectorXd b = robot_model->biasForces().tail(na);
+        const base::VectorXd& h = robot_model->biasForces();
 
-        for(uint i = 0; i < robot_model->noOfActuatedJoints(); i++){
-            const std::string& name = robot_model->actuatedJointNames()[i];
-            lb_vec(i) = robot_model->jointLimits()[name].min.effort - b(i);
-            ub_vec(i) = robot_model->jointLimits()[name].max.effort - b(i);
+        for(uint i = 0; i < na; i++){
+            const base::JointLimitRange &range = robot_model->jointLimits()[joint_limit_indices[i]];
+            lb_vec(i) = range.min.effort - h(nj-na+i);
+            ub_vec(i) = range.max.effort - h(nj-na+i);
         }
     }
 
@@ -17,6 +17,8 @@ namespace wbc{
         uint nc = robot_model->getActiveContacts().size();
         uint nv = reduced ? nj+6*nc : nj+na+6*nc;
 
+        updateJointIndices(robot_model);
+
         lb_vec.resize(nv);
         ub_vec.resize(nv);
         lb_vec.setConstant(-10000);
@@ -26,7 +28,7 @@ namespace wbc{
         bool check_velocities = true;
         bool check_positions = true;
         
-        auto state = robot_model->jointState(robot_model->actuatedJointNames());
+        const base::samples::Joints& state = robot_model->jointState(robot_model->actuatedJointNames());
 
         // check if a value is not nan otherwise return a substiture value
         // used for acceleration limits since they might not be define in URDFs
@@ -37,12 +39,12 @@ namespace wbc{
         };
 
         // joint acceleration, velocity and position limits
-        for(auto n : robot_model->actuatedJointNames()){
-            size_t idx = robot_model->jointIndex(n);
-            const base::JointLimitRange &range = robot_model->jointLimits().getElementByName(n);
+        for(uint i = 0; i < na; i++){
+            size_t idx = joint_indices[i];
+            const base::JointLimitRange &range = robot_model->jointLimits()[joint_limit_indices[i]];
 
-            double pos = state[n].position;
-            double vel = state[n].speed;
+            double pos = state[i].position;
+            double vel = state[i].speed;
 
             // enforce joint acceleration and velocity limit
             if(check_accelerations)
@@ -68,10 +70,10 @@ namespace wbc{
         if(reduced)
             return;
 
-        for(int i = 0; i < robot_model->noOfActuatedJoints(); i++){
-            const std::string& name = robot_model->actuatedJointNames()[i];
-            lb_vec(i+nj) = robot_model->jointLimits()[name].min.effort;
-            ub_vec(i+nj) = robot_model->jointLimits()[name].max.effort;
+        for(uint i = 0; i < na; i++){
+            const base::JointLimitRange &range = robot_model->jointLimits()[joint_limit_indices[i]];
+            lb_vec(i+nj) = range.min.effort;
+            ub_vec(i+nj) = range.max.effort;
         }
     }
 
@@ -12,6 +12,9 @@ namespace wbc{
     void JointLimitsVelocityConstraint::update(RobotModelPtr robot_model) {
 
         uint nj = robot_model->noOfJoints();
+        uint na = robot_model->noOfActuatedJoints();
+
+        updateJointIndices(robot_model);
 
         // vars are velocities
         lb_vec.resize(nj);
@@ -20,15 +23,15 @@ namespace wbc{
         lb_vec.setConstant(-999999);
         ub_vec.setConstant(+999999);
         
-        auto state = robot_model->jointState(robot_model->actuatedJointNames());
+        const base::samples::Joints& state = robot_model->jointState(robot_model->actuatedJointNames());
 
-        for(auto n : robot_model->actuatedJointNames()){
-            size_t idx = robot_model->jointIndex(n);
-            const base::JointLimitRange &range = robot_model->jointLimits().getElementByName(n);
+        for(uint i = 0; i < na; i++){
+            size_t idx = joint_indices[i];
+            const base::JointLimitRange &range = robot_model->jointLimits()[joint_limit_indices[i]];
 
             // enforce joint velocity and position limits
-            lb_vec(idx) = std::max(static_cast<double>(range.min.speed), (range.min.position - state[n].position) / dt);
-            ub_vec(idx) = std::min(static_cast<double>(range.max.speed), (range.max.position - state[n].position) / dt);
+            lb_vec(idx) = std::max(static_cast<double>(range.min.speed), (range.min.position - state[i].position) / dt);
+            ub_vec(idx) = std::min(static_cast<double>(range.max.speed), (range.max.position - state[i].position) / dt);
             lb_vec(idx) = std::min(lb_vec(idx), 0.0); // Why is this required?
             ub_vec(idx) = std::max(ub_vec(idx), 0.0);
         }
@@ -5,6 +5,7 @@ namespace wbc{
     void RigidbodyDynamicsConstraint::update(RobotModelPtr robot_model) {
         
         const ActiveContacts& contacts = robot_model->getActiveContacts();
+        registerContactChains(robot_model);
 
         uint nj = robot_model->noOfJoints();
         uint na = robot_model->noOfActuatedJoints();
@@ -12,29 +13,33 @@ namespace wbc{
 
         uint nv = reduced ? (nj + nc*6) : (nj + na + nc*6);
 
+        if(contact_jacobians.rows() != nc*6 || contact_jacobians.cols() != nj)
+            contact_jacobians.resize(nc*6, nj);
+        robot_model->bodyJacobians(contact_handles, contact_jacobians);
+
         if(reduced) // no torques in qp, consider only floating base dynamics
         {
-            A_mtx.resize(6, nv);
-            A_mtx.setZero();
-
-            b_vec.resize(6);
+            // Resize only if the problem dimensions change. All entries that are not overwritten below are constant zero
+            if(A_mtx.rows() != 6 || A_mtx.cols() != nv){
+                A_mtx.setZero(6, nv);
+                b_vec.resize(6);
+            }
 
             A_mtx.block(0,  0, 6, nj) =  robot_model->jointSpaceInertiaMatrix().topRows<6>();
-            for(int i = 0; i < contacts.size(); i++)
-                A_mtx.block(0, nj+i*6, 6, 6) = -robot_model->bodyJacobian(robot_model->worldFrame(), contacts.names[i]).transpose().topRows<6>();
+            A_mtx.block(0, nj, 6, nc*6) = -contact_jacobians.leftCols<6>().transpose();
             b_vec = -robot_model->biasForces().topRows<6>();
         }
         else
         {
-            A_mtx.resize(nj, nv);
-            A_mtx.setZero();
-            
-            b_vec.resize(nj);
+            // Resize only if the problem dimensions change. All entries that are not overwritten below are constant
+            if(A_mtx.rows() != nj || A_mtx.cols() != nv){
+                A_mtx.setZero(nj, nv);
+                b_vec.resize(nj);
+                A_mtx.block(0, nj, nj, na) = -robot_model->selectionMatrix().transpose();
+            }
 
             A_mtx.block(0,  0, nj, nj) =  robot_model->jointSpaceInertiaMatrix();
-            A_mtx.block(0, nj, nj, na) = -robot_model->selectionMatrix().transpose();
-            for(int i = 0; i < contacts.size(); i++)
-                A_mtx.block(0, nj+na+i*6, nj, 6) = -robot_model->bodyJacobian(robot_model->worldFrame(), contacts.names[i]).transpose();
+            A_mtx.block(0, nj+na, nj, nc*6) = -contact_jacobians.transpose();
             b_vec = -robot_model->biasForces();
         }
 
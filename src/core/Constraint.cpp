@@ -34,6 +34,40 @@ const base::VectorXd& Constraint::ub() {
     return ub_vec;
 }
 
+void Constraint::registerContactChains(RobotModelPtr robot_model){
+    const ActiveContacts& contacts = robot_model->getActiveContacts();
+    if(contact_names == contacts.names)
+        return;
+    contact_names = contacts.names;
+    contact_handles.resize(contacts.size());
+    for(uint i = 0; i < contacts.size(); i++)
+        contact_handles[i] = robot_model->registerChain(robot_model->worldFrame(), contacts.names[i]);
+}
+
+void Constraint::updateJointIndices(RobotModelPtr robot_model){
+    const std::vector<std::string>& names = robot_model->actuatedJointNames();
+    if(joint_indices.size() == names.size())
+        return;
+    joint_indices.resize(names.size());
+    joint_limit_indices.resize(names.size());
+    for(uint i = 0; i < names.size(); i++){
+        joint_indices[i] = robot_model->jointIndex(names[i]);
+        joint_limit_indices[i] = robot_model->jointLimits().mapNameToIndex(names[i]);
+    }
+}
+
+void Constraint::reset(){
+    contact_handles.clear();
+    contact_names.clear();
+    joint_indices.clear();
+    joint_limit_indices.clear();
+    contact_jacobians.resize(0,0);
+    A_mtx.resize(0,0);
+    b_vec.resize(0);
+    lb_vec.resize(0);
+    ub_vec.resize(0);
+}
+
 uint Constraint::size() {
     switch(c_type) {
         case Constraint::equality:
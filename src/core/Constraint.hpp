@@ -48,6 +48,9 @@ public:
     /** @brief return size of the constraint (i.e. number of rows of the constraint matrix) */
     uint size();
 
+    /** @brief Clear all cached information about the robot model (chain handles, joint indices, constant matrix entries). Has to be called if the robot model is reconfigured*/
+    void reset();
+
 protected:
 
     /** @brief Default constructor */
@@ -56,8 +59,31 @@ protected:
     /** @brief Constructor. Initialiye the type of this constraint */
     Constraint(Type type);
 
+    /** @brief Register the kinematic chains world frame -> contact point for all contact points of the robot model (see RobotModel::registerChain()).
+     *  The chains are only registered again if the names of the active contacts change*/
+    void registerContactChains(RobotModelPtr robot_model);
+
+    /** @brief Look up the indices of all actuated joints in the joint vector and in the joint limits of the robot model. The look up is
+     *  only done again if the number of actuated joints changes*/
+    void updateJointIndices(RobotModelPtr robot_model);
+
     Type c_type;
 
+    /** Handles of the kinematic chains world frame -> contact point, same order as the active contacts of the robot model */
+    std::vector<uint> contact_handles;
+
+    /** Names of the contact points the handles in contact_handles were registered for*/
+    std::vector<std::string> contact_names;
+
+    /** Stacked Body Jacobians of all contact points (6*nc x nj), see RobotModel::bodyJacobians()*/
+    base::MatrixXd contact_jacobians;
+
+    /** Index of each actuated joint in the joint vector of the robot model*/
+    std::vector<uint> joint_indices;
+
+    /** Index of each actuated joint in the joint limits of the robot model*/
+    std::vector<uint> joint_limit_indices;
+
     /** Constraint matrix */
     base::MatrixXd A_mtx;
 
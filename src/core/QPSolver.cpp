@@ -1,8 +1,43 @@
 #include "QPSolver.hpp"
+#include <limits>
+#include <algorithm>
+#include <stdexcept>
 
 namespace wbc{
 
-QPSolver::QPSolver() : configured(false){
+void SolverStats::reset(){
+    solve_time = std::numeric_limits<double>::quiet_NaN();
+    n_iter = -1;
+    n_active = -1;
+    primal_residual = std::numeric_limits<double>::quiet_NaN();
+    dual_residual = std::numeric_limits<double>::quiet_NaN();
+    status = -1;
+    budget_exceeded = false;
+}
+
+QPSolver::QPSolver() : configured(false), time_budget(0), time_per_iteration(0){
+}
+
+void QPSolver::setTimeBudget(double budget){
+    if(budget < 0)
+        throw std::invalid_argument("QPSolver: Time budget has to be >= 0");
+    time_budget = budget;
+}
+
+int QPSolver::budgetedMaxIter(int max_iter) const{
+    if(time_budget <= 0 || time_per_iteration <= 0)
+        return max_iter;
+    return std::max(1, (int)std::min((double)max_iter, time_budget / time_per_iteration));
+}
+
+void QPSolver::updateTimePerIteration(double time, int n_iter){
+    if(n_iter <= 0)
+        return;
+    // Exponential moving average, so that the estimate adapts to changing problem structure
+    if(time_per_iteration <= 0)
+        time_per_iteration = time / n_iter;
+    else
+        time_per_iteration = 0.9 * time_per_iteration + 0.1 * time / n_iter;
 }
 
 QPSolver::~QPSolver(){
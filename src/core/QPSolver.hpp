@@ -6,14 +6,62 @@
 #include <memory>
 #include <map>
 #include "QPSolverConfig.hpp"
+#include "TimingStats.hpp"
 
 namespace wbc{
 
 class HierarchicalQP;
 
+/**
+ * @brief Diagnostics of the last call to QPSolver::solve(). All solvers fill this struct in each call to solve(), also if solve() throws. Entries
+ *  that are not provided by a particular solver are set to -1 (integers) or NaN (floating point values).
+ */
+struct SolverStats{
+    SolverStats(){reset();}
+
+    /** Set all entries to "not available"*/
+    void reset();
+
+    double solve_time;          /** Wall time of the last call to solve() in seconds*/
+    int n_iter;                 /** Number of iterations (e.g. working set recalculations for active set solvers)*/
+    int n_active;               /** Number of active inequality constraints and bounds at the solution*/
+    double primal_residual;     /** Max. violation of the equality constraints, inequality constraints and bounds at the solution. For hierarchical
+                                    solvers, this refers to the highest priority level*/
+    double dual_residual;       /** Max. absolute value of the gradient of the Lagrangian at the solution*/
+    int status;                 /** Solver specific status code (e.g. qpOASES::returnValue). 0 means success for all solvers*/
+    bool budget_exceeded;       /** True if the solver was stopped due to the time budget (see QPSolver::setTimeBudget()), i.e. the solver output
+                                    is not the optimal solution*/
+};
+
 class QPSolver{
 protected:
     bool configured;
+    SolverStats stats;
+
+    /** Resets the solver stats on construction and writes the elapsed wall time to the solver stats on destruction. Create one
+     *  instance at the beginning of solve(), so that the time is also recorded if solve() throws*/
+    class SolveTimer{
+    public:
+        SolveTimer(SolverStats& stats) : stats(stats), start(TimingStats::Clock::now()){stats.reset();}
+        ~SolveTimer(){stats.solve_time = elapsed();}
+        /** Time since the start of solve() in seconds*/
+        double elapsed() const {return TimingStats::elapsed(start);}
+    private:
+        SolverStats& stats;
+        TimingStats::Clock::time_point start;
+    };
+
+    double time_budget;             /** Wall time budget per call to solve() in seconds. <= 0 means no budget*/
+    double time_per_iteration;      /** Estimated wall time per solver iteration in seconds, 0 if unknown*/
+    base::VectorXd last_solution;   /** Solution of the last successful call to solve(), may be used as fallback if the time budget is exceeded*/
+
+    /** Return the max. number of iterations for the next call to solve(), so that the time budget is not exceeded. This is estimated from the
+     *  measured time per iteration of the previous calls (see updateTimePerIteration()). Returns max_iter if there is no budget or no estimate yet*/
+    int budgetedMaxIter(int max_iter) const;
+
+    /** Update the estimate of the time per iteration with the time and number of iterations of the current call to solve()*/
+    void updateTimePerIteration(double time, int n_iter);
+
 public:
     QPSolver();
     virtual ~QPSolver();
@@ -26,6 +74,22 @@ public:
 
     /** @brief reset Enforces reconfiguration at next call to solve() */
     void reset(){configured=false;}
+
+    /** @brief Return true if the solver reads the equality and inequality constraints from the row-major staging buffer of the
+     *  QuadraticProgram (see QuadraticProgram::resize()). Scenes should then build the QP in staged form to avoid copying the constraints*/
+    virtual bool constraintStaging() const {return false;}
+
+    /** @brief Return the diagnostics of the last call to solve()*/
+    const SolverStats& getStats() const {return stats;}
+
+    /** @brief Set a wall time budget in seconds for each call to solve(). If the budget is exceeded, solve() does not throw, but returns the
+     *  best available solution and sets SolverStats::budget_exceeded. Depending on the solver, this is the current iterate (if it is feasible) or
+     *  the solution of the last successful call to solve(). If neither is available, solve() throws. Iterative solvers without native time limit derive an iteration limit from the measured time per
+     *  iteration, so that the budget is not enforced on the first call. 0 (default) means no budget. Has to be >= 0*/
+    void setTimeBudget(double budget);
+
+    /** @brief Return the wall time budget per call to solve() in seconds*/
+    double getTimeBudget() const {return time_budget;}
 };
 
 typedef std::shared_ptr<QPSolver> QPSolverPtr;
@@ -1,14 +1,28 @@
 #include "QuadraticProgram.hpp"
 #include <iostream>
+#include <algorithm>
+#include <cmath>
 
 namespace wbc {
 
-void QuadraticProgram::resize(const uint _nq, const uint _neq, const uint _nin, bool _bounds){
+void QuadraticProgram::resize(const uint _nq, const uint _neq, const uint _nin, bool _bounds, bool _staged){
+
     neq = _neq;
     nin = _nin;
     nq = _nq;
 
     bounded = _bounds;
+    staged = _staged;
+
+    // Either A/C or the staging buffer hold the constraints
+    const int neq_unstaged = staged ? 0 : neq;
+    const int nin_unstaged = staged ? 0 : nin;
+    const int n_staged = staged ? neq + nin : 0;
+
+    // Reuse the existing memory in case the problem dimensions did not change
+    if(H.rows() == nq && A.rows() == neq_unstaged && A.cols() == nq && C.rows() == nin_unstaged && C.cols() == nq &&
+       staged_constraints.rows() == n_staged && staged_constraints.cols() == nq && lower_x.size() == (bounded ? nq : 0) && Wy.size() == neq+nin)
+        return;
 
     // cost function
     H.resize(nq, nq);
@@ -17,19 +31,27 @@ void QuadraticProgram::resize(const uint _nq, const uint _neq, const uint _nin,
     g.setConstant(std::numeric_limits<double>::quiet_NaN());
 
     // equalities
-    A.resize(neq, nq);
+    A.resize(neq_unstaged, nq);
     A.setConstant(std::numeric_limits<double>::quiet_NaN());
-    b.resize(neq);
+    b.resize(neq_unstaged);
     b.setConstant(std::numeric_limits<double>::quiet_NaN());
 
     // inequalities
-    C.resize(nin, nq);
+    C.resize(nin_unstaged, nq);
     C.setConstant(std::numeric_limits<double>::quiet_NaN());
-    lower_y.resize(nin);
+    lower_y.resize(nin_unstaged);
     lower_y.setConstant(std::numeric_limits<double>::quiet_NaN());
-    upper_y.resize(nin);
+    upper_y.resize(nin_unstaged);
     upper_y.setConstant(std::numeric_limits<double>::quiet_NaN());
 
+    // staged equalities and inequalities
+    staged_constraints.resize(n_staged, nq);
+    staged_constraints.setConstant(std::numeric_limits<double>::quiet_NaN());
+    staged_lower.resize(n_staged);
+    staged_lower.setConstant(std::numeric_limits<double>::quiet_NaN());
+    staged_upper.resize(n_staged);
+    staged_upper.setConstant(std::numeric_limits<double>::quiet_NaN());
+
     // bounds
     lower_x.resize(bounded ? nq : 0);
     lower_x.setConstant(std::numeric_limits<double>::quiet_NaN());
@@ -39,6 +61,31 @@ void QuadraticProgram::resize(const uint _nq, const uint _neq, const uint _nin,
     Wy.setOnes(neq+nin);
 }
 
+void QuadraticProgram::setEqualityConstraints(uint row, const base::MatrixXd& A_eq, const base::VectorXd& b_eq){
+    if(staged){
+        staged_constraints.middleRows(row, A_eq.rows()) = A_eq;
+        staged_lower.segment(row, b_eq.size()) = b_eq;
+        staged_upper.segment(row, b_eq.size()) = b_eq;
+    }
+    else{
+        A.middleRows(row, A_eq.rows()) = A_eq;
+        b.segment(row, b_eq.size()) = b_eq;
+    }
+}
+
+void QuadraticProgram::setInequalityConstraints(uint row, const base::MatrixXd& A_in, const base::VectorXd& lower, const base::VectorXd& upper){
+    if(staged){
+        staged_constraints.middleRows(neq + row, A_in.rows()) = A_in;
+        staged_lower.segment(neq + row, lower.size()) = lower;
+        staged_upper.segment(neq + row, upper.size()) = upper;
+    }
+    else{
+        C.middleRows(row, A_in.rows()) = A_in;
+        lower_y.segment(row, lower.size()) = lower;
+        upper_y.segment(row, upper.size()) = upper;
+    }
+}
+
 void QuadraticProgram::check() const {
     if(bounded) {
         if(lower_x.size() != nq)
@@ -56,20 +103,30 @@ void QuadraticProgram::check() const {
             std::cout<<"Quadratic program has not bounds "
                 "but upper bound has size " + std::to_string(lower_x.size()) + " (nq:" + std::to_string(nq) + ")"<<std::endl;
     }
-    if(C.rows() != nin || C.cols() != nq)
-        std::cout<<"Inequality constraint matrix C should have size " + std::to_string(nin) + "x" + std::to_string(nq) +
+    // If the constraints are staged, A/b and C/lower_y/upper_y are empty
+    const int neq_unstaged = staged ? 0 : neq;
+    const int nin_unstaged = staged ? 0 : nin;
+    const int n_staged = staged ? neq + nin : 0;
+    if(C.rows() != nin_unstaged || C.cols() != nq)
+        std::cout<<"Inequality constraint matrix C should have size " + std::to_string(nin_unstaged) + "x" + std::to_string(nq) +
             "but has size " +  std::to_string(C.rows()) + "x" + std::to_string(C.cols())<<std::endl;
-    if(lower_y.size() != nin)
+    if(lower_y.size() != nin_unstaged)
         std::cout<<"Number of inequality constraints in quadratic program is " + std::to_string(nin)
             + ", but lower bound has size " + std::to_string(lower_y.size())<<std::endl;
-    if(upper_y.size() != nin)
+    if(upper_y.size() != nin_unstaged)
         std::cout<<"Number of inequality constraints in quadratic program is " + std::to_string(nin)
             + ", but lower bound has size " + std::to_string(lower_y.size())<<std::endl;
-    if(A.rows() != neq || A.cols() != nq)
-        std::cout<<"Equality constraint matrix A should have size " + std::to_string(neq) + "x" + std::to_string(nq) +
+    if(A.rows() != neq_unstaged || A.cols() != nq)
+        std::cout<<"Equality constraint matrix A should have size " + std::to_string(neq_unstaged) + "x" + std::to_string(nq) +
             "but has size " +  std::to_string(A.rows()) + "x" + std::to_string(A.cols())<<std::endl;
-    if(b.size() != neq)
-            std::cout<<"Equality constraint vector b should have size " + std::to_string(neq) + "but has size " + std::to_string(b.size())<<std::endl;
+    if(b.size() != neq_unstaged)
+            std::cout<<"Equality constraint vector b should have size " + std::to_string(neq_unstaged) + "but has size " + std::to_string(b.size())<<std::endl;
+    if(staged_constraints.rows() != n_staged || staged_constraints.cols() != nq)
+        std::cout<<"Staged constraint matrix should have size " + std::to_string(n_staged) + "x" + std::to_string(nq) +
+            "but has size " +  std::to_string(staged_constraints.rows()) + "x" + std::to_string(staged_constraints.cols())<<std::endl;
+    if(staged_lower.size() != n_staged || staged_upper.size() != n_staged)
+        std::cout<<"Staged constraint bounds should have size " + std::to_string(n_staged) + "but have size " + std::to_string(staged_lower.size())
+            + " and " + std::to_string(staged_upper.size())<<std::endl;
     if(H.rows() != nq || H.cols() != nq)
         std::cout<<"Hessian matrix H should have size " + std::to_string(nq) + "x" + std::to_string(nq) +
             "but has size " +  std::to_string(H.rows()) + "x" + std::to_string(H.cols())<<std::endl;
@@ -77,10 +134,34 @@ void QuadraticProgram::check() const {
         std::cout<<"Gradient vector g should have size " + std::to_string(nq) + "but has size " + std::to_string(g.size())<<std::endl;
 }
 
+double QuadraticProgram::primalResidual(const base::VectorXd& x) const{
+    double residual = 0;
+    if(staged){
+        for(int i = 0; i < staged_constraints.rows(); i++){
+            const double y = staged_constraints.row(i).dot(x);
+            residual = std::max(residual, std::max(staged_lower[i] - y, y - staged_upper[i]));
+        }
+    }
+    else{
+        for(int i = 0; i < neq; i++)
+            residual = std::max(residual, std::abs(A.row(i).dot(x) - b[i]));
+        for(int i = 0; i < nin; i++){
+            const double y = C.row(i).dot(x);
+            residual = std::max(residual, std::max(lower_y[i] - y, y - upper_y[i]));
+        }
+    }
+    if(bounded){
+        for(int i = 0; i < nq; i++)
+            residual = std::max(residual, std::max(lower_x[i] - x[i], x[i] - upper_x[i]));
+    }
+    return residual;
+}
+
 void QuadraticProgram::print() const {
     std::cout << "-- Quadratic Program --" << std::endl;
     std::cout << "Size nq: " << nq << "  neq: " << neq << "  nin:" << nin << std::endl;
     std::cout << "bounded: " << (bounded ? "true" : "false") << std::endl;
+    std::cout << "staged: " << (staged ? "true" : "false") << std::endl;
     std::cout << "H" << std::endl;
     std::cout << H << std::endl;
     std::cout << "g" << std::endl;
@@ -95,6 +176,14 @@ void QuadraticProgram::print() const {
     std::cout << lower_y.transpose() << std::endl;
     std::cout << "upper_y" << std::endl;
     std::cout << upper_y.transpose() << std::endl;
+    if(staged){
+        std::cout << "staged_constraints" << std::endl;
+        std::cout << staged_constraints << std::endl;
+        std::cout << "staged_lower" << std::endl;
+        std::cout << staged_lower.transpose() << std::endl;
+        std::cout << "staged_upper" << std::endl;
+        std::cout << staged_upper.transpose() << std::endl;
+    }
     std::cout << "lower_x" << std::endl;
     std::cout << lower_x.transpose() << std::endl;
     std::cout << "upper_x" << std::endl;
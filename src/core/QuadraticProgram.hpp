@@ -23,11 +23,16 @@ class JointWeights : public base::NamedVector<double>{
  */
 struct QuadraticProgram{
 
+    typedef Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> RowMajorMatrixXd;
+
     int nq;                 /** Number of variables */
     int neq;                /** Number of equalities constraints for this prio*/
     int nin;                /** Number of inequalities constraints for this prio*/
 
     bool bounded;            /** Contains simple boiunds for the variables */
+    bool staged = false;     /** Equality and inequality constraints are stored in the row-major staging buffer instead of A/b and C/lower_y/upper_y, see resize()*/
+    bool soft_constraints = false; /** Equality and inequality constraints are tasks that may be violated in favor of higher priority levels (weighted
+                                       with Wy), e.g. in the VelocityScene. Otherwise they are hard constraints. Only used by the HierarchicalQPSolver*/
 
     base::MatrixXd H;       /** Hessian Matrix (nq x nq) */
     base::VectorXd g;       /** Gradient vector (nq x 1) */
@@ -40,8 +45,22 @@ struct QuadraticProgram{
     base::VectorXd upper_x; /** Upper bound of the solution vector (nq x 1) */
     base::VectorXd Wy;      /** Constraint weights (nc x 1). Default entry is 1. */
 
-    /** Initialize all variables with NaN */
-    void resize(uint nq, uint neq, uint nin, bool bounds);
+    RowMajorMatrixXd staged_constraints; /** Staged constraint matrix [A; C] in row-major order ((neq+nin) x nq). Only used if staged is true*/
+    base::VectorXd staged_lower;         /** Staged lower constraint bound [b; lower_y] ((neq+nin) x 1). Only used if staged is true*/
+    base::VectorXd staged_upper;         /** Staged upper constraint bound [b; upper_y] ((neq+nin) x 1). Only used if staged is true*/
+
+    /** Resize all variables and initialize them with NaN. Does nothing if the problem dimensions did not change, so that the
+     *  memory of the QP can be reused in each control cycle. If staged is true, the equality and inequality constraints are stored
+     *  stacked in row-major order in staged_constraints/staged_lower/staged_upper, and A, b, C, lower_y and upper_y are empty. This avoids
+     *  copying the constraints for solvers that require row-major input (see QPSolver::constraintStaging()). Use setEqualityConstraints() and
+     *  setInequalityConstraints() to fill the constraints in both cases*/
+    void resize(uint nq, uint neq, uint nin, bool bounds, bool staged = false);
+
+    /** Set the equality constraints A_eq*x = b_eq starting at the given row of A/b (or of the staging buffer, if staged)*/
+    void setEqualityConstraints(uint row, const base::MatrixXd& A_eq, const base::VectorXd& b_eq);
+
+    /** Set the inequality constraints lower <= A_in*x <= upper starting at the given row of C/lower_y/upper_y (or of the staging buffer, if staged)*/
+    void setInequalityConstraints(uint row, const base::MatrixXd& A_in, const base::VectorXd& lower, const base::VectorXd& upper);
 
     /** Check if matrix and vectors dims match with nq, neq, nin. Throw exception if not **/
     void check() const;
@@ -49,6 +68,9 @@ struct QuadraticProgram{
     /** Print content to console*/
     void print() const;
 
+    /** Return the max. violation of the equality constraints, inequality constraints and bounds for the given solution. Does not allocate memory*/
+    double primalResidual(const base::VectorXd& x) const;
+
 };
 
 /**
@@ -3,6 +3,7 @@
 #include <base/samples/RigidBodyStateSE3.hpp>
 #include <base/samples/Joints.hpp>
 #include <fstream>
+#include <set>
 #include <urdf_parser/urdf_parser.h>
 
 namespace wbc{
@@ -13,7 +14,10 @@ std::vector<std::string> operator+(std::vector<std::string> a, std::vector<std::
 }
 
 RobotModel::RobotModel() :
-    gravity(base::Vector3d(0,0,-9.81)){
+    gravity(base::Vector3d(0,0,-9.81)),
+    joint_state_layout_bound(false),
+    joint_state_layout_explicit(false){
+    invalidateCache();
 }
 
 void RobotModel::clear(){
@@ -30,9 +34,22 @@ void RobotModel::clear(){
     robot_urdf.reset();
     joint_state.clear();
     joint_state_out.clear();
+    joint_state_in_names.clear();
+    joint_state_in_indices.clear();
+    actuated_joint_indices.clear();
+    joint_state_layout_bound = false;
+    joint_state_layout_explicit = false;
     space_jac_map.clear();
     body_jac_map.clear();
     jac_dot_map.clear();
+    chain_cache.clear();
+    invalidateCache();
+}
+
+void RobotModel::invalidateCache(){
+    joint_space_inertia_mat_valid = bias_forces_valid = com_valid = com_jac_valid = false;
+    for(ChainCache& c : chain_cache)
+        c.space_jac_valid = c.body_jac_valid = c.acc_bias_valid = c.jac_dot_valid = false;
 }
 
 void RobotModel::setActiveContacts(const ActiveContacts &contacts){
@@ -45,6 +62,136 @@ void RobotModel::setActiveContacts(const ActiveContacts &contacts){
     active_contacts = contacts;
 }
 
+uint RobotModel::registerChain(const std::string &root_frame, const std::string &tip_frame){
+    for(uint i = 0; i < chains.size(); i++){
+        if(chains[i].first == root_frame && chains[i].second == tip_frame)
+            return i;
+    }
+    chains.push_back(std::make_pair(root_frame, tip_frame));
+    return chains.size() - 1;
+}
+
+const std::pair<std::string,std::string>& RobotModel::chain(uint chain_handle){
+    if(chain_handle >= chains.size()){
+        LOG_ERROR("RobotModel: Requested kinematic chain with handle %i, but only %i chains have been registered", chain_handle, chains.size());
+        throw std::invalid_argument("Invalid chain handle");
+    }
+    return chains[chain_handle];
+}
+
+RobotModel::ChainCache& RobotModel::chainCache(uint chain_handle){
+    chain(chain_handle); // Check validity of the handle
+    if(chain_cache.size() < chains.size())
+        chain_cache.resize(chains.size());
+    return chain_cache[chain_handle];
+}
+
+const base::samples::RigidBodyStateSE3 &RobotModel::rigidBodyState(uint chain_handle){
+    const std::pair<std::string,std::string>& c = chain(chain_handle);
+    return rigidBodyState(c.first, c.second);
+}
+
+const base::MatrixXd &RobotModel::spaceJacobian(uint chain_handle){
+    ChainCache& cache = chainCache(chain_handle);
+    if(!cache.space_jac_valid){
+        const std::pair<std::string,std::string>& c = chains[chain_handle];
+        cache.space_jac = spaceJacobian(c.first, c.second);
+        cache.space_jac_valid = true;
+    }
+    return cache.space_jac;
+}
+
+const base::MatrixXd &RobotModel::bodyJacobian(uint chain_handle){
+    ChainCache& cache = chainCache(chain_handle);
+    if(!cache.body_jac_valid){
+        const std::pair<std::string,std::string>& c = chains[chain_handle];
+        cache.body_jac = bodyJacobian(c.first, c.second);
+        cache.body_jac_valid = true;
+    }
+    return cache.body_jac;
+}
+
+const base::Acceleration &RobotModel::spatialAccelerationBias(uint chain_handle){
+    ChainCache& cache = chainCache(chain_handle);
+    if(!cache.acc_bias_valid){
+        const std::pair<std::string,std::string>& c = chains[chain_handle];
+        cache.acc_bias = spatialAccelerationBias(c.first, c.second);
+        cache.acc_bias_valid = true;
+    }
+    return cache.acc_bias;
+}
+
+const base::MatrixXd &RobotModel::jacobianDot(uint chain_handle){
+    ChainCache& cache = chainCache(chain_handle);
+    if(!cache.jac_dot_valid){
+        const std::pair<std::string,std::string>& c = chains[chain_handle];
+        cache.jac_dot = jacobianDot(c.first, c.second);
+        cache.jac_dot_valid = true;
+    }
+    return cache.jac_dot;
+}
+
+void RobotModel::spaceJacobians(const std::vector<uint> &chain_handles, Eigen::Ref<base::MatrixXd> jacobians){
+    if(jacobians.rows() != 6*chain_handles.size() || jacobians.cols() != noOfJoints()){
+        LOG_ERROR_S << "Output buffer has size " << jacobians.rows() << "x" << jacobians.cols() << " but should have size " << 6*chain_handles.size() << "x" << noOfJoints() << std::endl;
+        throw std::invalid_argument("Invalid buffer size in spaceJacobians()");
+    }
+    for(uint i = 0; i < chain_handles.size(); i++)
+        jacobians.middleRows<6>(6*i) = spaceJacobian(chain_handles[i]);
+}
+
+void RobotModel::bodyJacobians(const std::vector<uint> &chain_handles, Eigen::Ref<base::MatrixXd> jacobians){
+    if(jacobians.rows() != 6*chain_handles.size() || jacobians.cols() != noOfJoints()){
+        LOG_ERROR_S << "Output buffer has size " << jacobians.rows() << "x" << jacobians.cols() << " but should have size " << 6*chain_handles.size() << "x" << noOfJoints() << std::endl;
+        throw std::invalid_argument("Invalid buffer size in bodyJacobians()");
+    }
+    for(uint i = 0; i < chain_handles.size(); i++)
+        jacobians.middleRows<6>(6*i) = bodyJacobian(chain_handles[i]);
+}
+
+void RobotModel::spatialAccelerationBiases(const std::vector<uint> &chain_handles, Eigen::Ref<base::VectorXd> acc){
+    if(acc.size() != 6*chain_handles.size()){
+        LOG_ERROR_S << "Output buffer has size " << acc.size() << " but should have size " << 6*chain_handles.size() << std::endl;
+        throw std::invalid_argument("Invalid buffer size in spatialAccelerationBiases()");
+    }
+    for(uint i = 0; i < chain_handles.size(); i++){
+        const base::Acceleration& a = spatialAccelerationBias(chain_handles[i]);
+        acc.segment<3>(6*i) = a.linear;
+        acc.segment<3>(6*i+3) = a.angular;
+    }
+}
+
+std::vector<uint> RobotModel::chainJointIndices(uint chain_handle){
+    const std::pair<std::string,std::string>& c = chain(chain_handle);
+
+    std::vector<uint> indices;
+    if(!robot_urdf || !robot_urdf->getLink(c.first) || !robot_urdf->getLink(c.second)){
+        // No structural information available, so all columns might be non-zero
+        for(uint i = 0; i < joint_names.size(); i++)
+            indices.push_back(i);
+        return indices;
+    }
+
+    auto joints_to_root = [this](const std::string& link_name){
+        std::set<std::string> joints;
+        urdf::LinkConstSharedPtr link = robot_urdf->getLink(link_name);
+        while(link->parent_joint){
+            joints.insert(link->parent_joint->name);
+            link = link->getParent();
+        }
+        return joints;
+    };
+
+    // Joints above the common ancestor of root and tip frame move both frames in the same way, so only the joints that are on exactly one of the
+    // two paths to the root of the URDF tree are relevant
+    std::set<std::string> root_joints = joints_to_root(c.first);
+    std::set<std::string> tip_joints = joints_to_root(c.second);
+    for(uint i = 0; i < joint_names.size(); i++){
+        if(root_joints.count(joint_names[i]) != tip_joints.count(joint_names[i]))
+            indices.push_back(i);
+    }
+    return indices;
+}
 
 uint RobotModel::jointIndex(const std::string &joint_name){
     uint idx = std::find(joint_names.begin(), joint_names.end(), joint_name) - joint_names.begin();
@@ -69,6 +216,85 @@ bool RobotModel::hasActuatedJoint(const std::string &joint_name){
     return std::find(actuated_joint_names.begin(), actuated_joint_names.end(), joint_name) != actuated_joint_names.end();
 }
 
+void RobotModel::bindJointStateLayout(const std::vector<std::string> &names){
+    joint_state_in_names.clear();
+    joint_state_in_indices.resize(actuated_joint_names.size());
+    actuated_joint_indices.resize(actuated_joint_names.size());
+    for(size_t i = 0; i < actuated_joint_names.size(); i++){
+        const std::string &name = actuated_joint_names[i];
+        size_t idx = std::find(names.begin(), names.end(), name) - names.begin();
+        if(idx >= names.size()){
+            LOG_ERROR_S << "Joint " << name << " is a non-fixed joint in the robot model, but it is not in the joint state vector."
+                        << "You should either set the joint to 'fixed' in your URDF file or provide a valid joint state for it" << std::endl;
+            throw std::runtime_error("Incomplete Joint State");
+        }
+        joint_state_in_indices[i] = idx;
+        actuated_joint_indices[i] = joint_state.mapNameToIndex(name);
+    }
+    joint_state_in_names = names;
+    joint_state_layout_bound = true;
+    joint_state_layout_explicit = true;
+}
+
+void RobotModel::updateJointState(const base::samples::Joints& joint_state_in){
+
+    if(joint_state_in.elements.size() != joint_state_in.names.size()){
+        LOG_ERROR_S << "Size of names and size of elements in joint state do not match"<<std::endl;
+        throw std::runtime_error("Invalid joint state");
+    }
+
+    if(joint_state_in.time.isNull()){
+        LOG_ERROR_S << "Joint State does not have a valid timestamp. Or do we have 1970?"<<std::endl;
+        throw std::runtime_error("Invalid joint state");
+    }
+
+    // joint_state itself is passed by update() from raw vectors, which has already written the actuated joints
+    if(&joint_state_in == &joint_state)
+        return;
+
+    // A layout that has been bound automatically from a previous input is checked by name, since the caller may change the joint order.
+    // An explicitly bound layout (see bindJointStateLayout()) is only checked by size
+    if(!joint_state_layout_bound || (!joint_state_layout_explicit && joint_state_in.names != joint_state_in_names)){
+        bindJointStateLayout(joint_state_in.names);
+        joint_state_layout_explicit = false;
+    }
+    else if(joint_state_in.size() != joint_state_in_names.size()){
+        LOG_ERROR_S << "Size of joint state (" << joint_state_in.size() << ") does not match the size of the bound joint state layout ("
+                    << joint_state_in_names.size() << "). Call bindJointStateLayout() if the joint layout changed" << std::endl;
+        throw std::invalid_argument("Invalid joint state");
+    }
+
+    for(size_t i = 0; i < joint_state_in_indices.size(); i++)
+        joint_state.elements[actuated_joint_indices[i]] = joint_state_in.elements[joint_state_in_indices[i]];
+    joint_state.time = joint_state_in.time;
+}
+
+void RobotModel::checkRawJointState(const base::VectorXd& q, const base::VectorXd& qd, const base::VectorXd& qdd) const{
+    if(!joint_state_layout_bound){
+        LOG_ERROR_S << "You have to call bindJointStateLayout() before updating the robot model from raw joint vectors" << std::endl;
+        throw std::runtime_error("Invalid call to update()");
+    }
+    const size_t n = joint_state_in_names.size();
+    if((size_t)q.size() != n || (size_t)qd.size() != n || (size_t)qdd.size() != n){
+        LOG_ERROR_S << "Size of q, qd or qdd (" << q.size() << ", " << qd.size() << ", " << qdd.size() << ") does not match the size of the bound joint state layout ("
+                    << n << ")" << std::endl;
+        throw std::invalid_argument("Invalid joint state");
+    }
+}
+
+void RobotModel::update(const base::VectorXd& q, const base::VectorXd& qd, const base::VectorXd& qdd, const base::Time& time,
+                        const base::samples::RigidBodyStateSE3& floating_base_state){
+    checkRawJointState(q, qd, qdd);
+    for(size_t i = 0; i < joint_state_in_indices.size(); i++){
+        base::JointState &js = joint_state.elements[actuated_joint_indices[i]];
+        js.position = q[joint_state_in_indices[i]];
+        js.speed = qd[joint_state_in_indices[i]];
+        js.acceleration = qdd[joint_state_in_indices[i]];
+    }
+    joint_state.time = time;
+    update(joint_state, floating_base_state);
+}
+
 const base::samples::Joints& RobotModel::jointState(const std::vector<std::string> &joint_names){
 
     if(joint_state.time.isNull()){
@@ -76,19 +302,26 @@ const base::samples::Joints& RobotModel::jointState(const std::vector<std::strin
         throw std::runtime_error("Invalid call to jointState()");
     }
 
-    joint_state_out.resize(joint_names.size());
-    joint_state_out.names = joint_names;
-    joint_state_out.time = joint_state.time;
-
-    for(size_t i = 0; i < joint_names.size(); i++){
-        try{
-            joint_state_out[i] = joint_state.getElementByName(joint_names[i]);
-        }
-        catch(std::exception e){
-            LOG_ERROR("RobotModel: Requested state of joint %s but this joint does not exist in robot model", joint_names[i].c_str());
-            throw std::invalid_argument("Invalid call to jointState()");
+    // Look up the joint indices only if the requested joint names changed since the last call
+    if(joint_state_out.names != joint_names){
+        joint_state_out.resize(joint_names.size());
+        joint_state_out_indices.resize(joint_names.size());
+        for(size_t i = 0; i < joint_names.size(); i++){
+            try{
+                joint_state_out_indices[i] = joint_state.mapNameToIndex(joint_names[i]);
+            }
+            catch(std::exception e){
+                joint_state_out.names.clear();
+                LOG_ERROR("RobotModel: Requested state of joint %s but this joint does not exist in robot model", joint_names[i].c_str());
+                throw std::invalid_argument("Invalid call to jointState()");
+            }
         }
+        joint_state_out.names = joint_names;
     }
+
+    joint_state_out.time = joint_state.time;
+    for(size_t i = 0; i < joint_names.size(); i++)
+        joint_state_out[i] = joint_state[joint_state_out_indices[i]];
     return joint_state_out;
 }
 
@@ -26,6 +26,35 @@ protected:
     /** ID of kinematic chain given root and tip*/
     const std::string chainID(const std::string& root, const std::string& tip){return root + "_" + tip;}
 
+    /** Kinematic chains (root and tip frame) that have been registered with registerChain(). The index in this vector is the chain handle.
+     *  Registered chains are not removed in clear(), so that handles remain valid if the model is reconfigured*/
+    std::vector< std::pair<std::string,std::string> > chains;
+
+    /** Return root and tip frame of the kinematic chain with the given handle. Throws if the handle is invalid*/
+    const std::pair<std::string,std::string>& chain(uint chain_handle);
+
+    /** Cached kinematic quantities of a registered kinematic chain. The valid flags are reset by invalidateCache()*/
+    struct ChainCache{
+        ChainCache() : space_jac_valid(false), body_jac_valid(false), acc_bias_valid(false), jac_dot_valid(false){}
+        base::MatrixXd space_jac;
+        base::MatrixXd body_jac;
+        base::MatrixXd jac_dot;
+        base::Acceleration acc_bias;
+        bool space_jac_valid, body_jac_valid, acc_bias_valid, jac_dot_valid;
+    };
+    /** Cached quantities of all registered kinematic chains. The index in this vector is the chain handle*/
+    std::vector<ChainCache> chain_cache;
+
+    /** Return the cache of the kinematic chain with the given handle. Throws if the handle is invalid*/
+    ChainCache& chainCache(uint chain_handle);
+
+    /** Validity flags of the cached dynamics quantities. They are reset by invalidateCache()*/
+    bool joint_space_inertia_mat_valid, bias_forces_valid, com_valid, com_jac_valid;
+
+    /** Mark all cached quantities (mass-inertia matrix, bias forces, CoM, CoM Jacobian and the Jacobians/acceleration biases of all chains) as invalid. Has to be
+     *  called in update() of each robot model, so that each quantity is computed at most once per state update*/
+    void invalidateCache();
+
     std::vector<std::string> contact_points;
     ActiveContacts active_contacts;
     base::Vector3d gravity;
@@ -56,6 +85,21 @@ protected:
 
     // Helper
     base::samples::Joints joint_state_out;
+    std::vector<uint> joint_state_out_indices;
+
+    bool joint_state_layout_bound;                 /** True if an input joint state layout has been bound, see bindJointStateLayout()*/
+    bool joint_state_layout_explicit;              /** True if the layout has been bound by the user, false if it has been bound automatically by update()*/
+    std::vector<std::string> joint_state_in_names; /** Joint names of the input joint state layout, see bindJointStateLayout()*/
+    std::vector<uint> joint_state_in_indices;      /** Index of each actuated joint in the input joint state layout*/
+    std::vector<uint> actuated_joint_indices;      /** Index of each actuated joint in joint_state*/
+
+    /** Check the given joint state and copy all actuated joints to joint_state using the bound input layout (see bindJointStateLayout()). If no
+     *  layout is bound yet or the joint names differ from an automatically bound layout, the layout of the given joint state is bound. If the
+     *  layout has been bound explicitly, only the size of the input is checked*/
+    void updateJointState(const base::samples::Joints& joint_state_in);
+
+    /** Throw if no joint state layout is bound or if the size of the given raw joint vectors does not match the bound layout*/
+    void checkRawJointState(const base::VectorXd& q, const base::VectorXd& qd, const base::VectorXd& qdd) const;
 
 public:
     RobotModel();
@@ -76,6 +120,27 @@ public:
     virtual void update(const base::samples::Joints& joint_state,
                         const base::samples::RigidBodyStateSE3& floating_base_state = base::samples::RigidBodyStateSE3()) = 0;
 
+    /**
+     * @brief Update the robot configuration from raw joint position, velocity and acceleration vectors. The entries have to be in the order given to bindJointStateLayout().
+     *        This does not require any joint name handling.
+     * @param q Joint positions. Size has to be the same as the bound joint state layout.
+     * @param qd Joint velocities. Size has to be the same as the bound joint state layout.
+     * @param qdd Joint accelerations. Size has to be the same as the bound joint state layout.
+     * @param time Timestamp of the joint state
+     * @param poses Optional, only for floating base robots: update the floating base state of the robot model.
+     */
+    virtual void update(const base::VectorXd& q, const base::VectorXd& qd, const base::VectorXd& qdd, const base::Time& time,
+                        const base::samples::RigidBodyStateSE3& floating_base_state = base::samples::RigidBodyStateSE3());
+
+    /**
+     * @brief Bind the joint order of the joint states that will be passed to update(). The index of each actuated joint in the given layout is computed only once here,
+     *        so that update() does not have to look up joint names. After calling this, update() only checks the size of its input, so this has to be
+     *        called again whenever the joint order of the input changes. If this is not called, update() binds the layout of its input automatically
+     *        and binds it again whenever the joint names of the input change.
+     * @param joint_names Joint names of the input joint state in the order they will be given. Has to contain all actuated joints of the robot model.
+     */
+    virtual void bindJointStateLayout(const std::vector<std::string> &joint_names);
+
     /** Returns the current status of the given joint names */
     const base::samples::Joints& jointState(const std::vector<std::string> &joint_names);
 
@@ -124,6 +189,54 @@ public:
       */
     virtual const base::MatrixXd &jacobianDot(const std::string &root_frame, const std::string &tip_frame) = 0;
 
+    /** @brief Register the kinematic chain between root and tip frame and return an integer handle for it. The handle can be used with the handle based
+      * overloads of rigidBodyState(), spaceJacobian(), bodyJacobian(), spatialAccelerationBias() and jacobianDot(), which do not require any string handling
+      * and can thus be used efficiently in the control loop. Registering the same chain twice returns the same handle. The validity of the given frames
+      * is checked when querying kinematic information for the chain.
+      * @param root_frame Root frame of the chain.
+      * @param tip_frame Tip frame of the chain.
+      * @return Handle of the kinematic chain
+      */
+    uint registerChain(const std::string &root_frame, const std::string &tip_frame);
+
+    /** @brief Same as rigidBodyState(root_frame, tip_frame), but for a chain handle obtained from registerChain()*/
+    virtual const base::samples::RigidBodyStateSE3 &rigidBodyState(uint chain_handle);
+
+    /** @brief Same as spaceJacobian(root_frame, tip_frame), but for a chain handle obtained from registerChain(). The result is computed at most once per update()*/
+    virtual const base::MatrixXd &spaceJacobian(uint chain_handle);
+
+    /** @brief Same as bodyJacobian(root_frame, tip_frame), but for a chain handle obtained from registerChain(). The result is computed at most once per update()*/
+    virtual const base::MatrixXd &bodyJacobian(uint chain_handle);
+
+    /** @brief Same as spatialAccelerationBias(root_frame, tip_frame), but for a chain handle obtained from registerChain(). The result is computed at most once per update()*/
+    virtual const base::Acceleration &spatialAccelerationBias(uint chain_handle);
+
+    /** @brief Same as jacobianDot(root_frame, tip_frame), but for a chain handle obtained from registerChain(). The result is computed at most once per update()*/
+    virtual const base::MatrixXd &jacobianDot(uint chain_handle);
+
+    /** @brief Compute the Space Jacobians for multiple kinematic chains in one call and write them to the given buffer. The Jacobian of the i-th chain
+      * is written to rows 6*i to 6*i+5. Columns that correspond to joints which are not part of a kinematic chain are set to zero.
+      * @param chain_handles Chain handles obtained from registerChain()
+      * @param jacobians Output buffer. Has to be of size 6*K x N, where K is the number of chain handles and N the number of robot joints. Can also be a block of a larger matrix.
+      */
+    virtual void spaceJacobians(const std::vector<uint> &chain_handles, Eigen::Ref<base::MatrixXd> jacobians);
+
+    /** @brief Same as spaceJacobians(), but for the Body Jacobians*/
+    virtual void bodyJacobians(const std::vector<uint> &chain_handles, Eigen::Ref<base::MatrixXd> jacobians);
+
+    /** @brief Compute the spatial acceleration bias for multiple kinematic chains in one call and write them to the given buffer. The acceleration bias of the i-th chain
+      * is written to elements 6*i to 6*i+5 (linear part first, then angular part)
+      * @param chain_handles Chain handles obtained from registerChain()
+      * @param acc Output buffer. Has to be of size 6*K, where K is the number of chain handles. Can also be a segment of a larger vector.
+      */
+    virtual void spatialAccelerationBiases(const std::vector<uint> &chain_handles, Eigen::Ref<base::VectorXd> acc);
+
+    /** @brief Return the indices (in the joint vector, see jointNames()) of all joints that move the tip relative to the root frame of the given kinematic chain, in
+      * ascending order. All other columns of the Jacobians of the chain are always zero. The default implementation evaluates the URDF tree and returns all joints if this is not possible
+      * @param chain_handle Chain handle obtained from registerChain()
+      */
+    virtual std::vector<uint> chainJointIndices(uint chain_handle);
+
     /** @brief Compute and return the joint space mass-inertia matrix, which is nj x nj, where nj is the number of joints of the system*/
     virtual const base::MatrixXd &jointSpaceInertiaMatrix() = 0;
 
@@ -152,7 +265,7 @@ public:
     const base::JointLimits& jointLimits(){return joint_limits;}
 
     /** @brief Return True if given link name is available in robot model, false otherwise*/
-    bool hasLink(const std::string& link_name);
+    virtual bool hasLink(const std::string& link_name);
 
     /** @brief Return True if given joint name is available in robot model, false otherwise*/
     bool hasJoint(const std::string& joint_name);
@@ -181,7 +294,7 @@ public:
     uint noOfActuatedJoints(){return actuatedJointNames().size();}
 
     /** @brief Set the current gravity vector*/
-    void setGravityVector(const base::Vector3d& g){gravity=g;}
+    void setGravityVector(const base::Vector3d& g){gravity=g; bias_forces_valid=false;}
 
     /** @brief Get current status of floating base*/
     const base::samples::RigidBodyStateSE3& floatingBaseState(){return floating_base_state;}
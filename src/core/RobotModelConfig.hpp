@@ -69,6 +69,9 @@ public:
     ActiveContacts contact_points;
 
     std::vector<std::string> joint_blacklist;
+    /** Optional: Directory in which the fully built robot model is stored in binary form. If configure() is called again with the same URDF, submechanism file, joint blacklist and
+     *  floating base flag, the model is restored from this cache instead of parsing the URDF. Currently only supported by the pinocchio robot model. Empty (default) means no cache*/
+    std::string model_cache_dir;
 };
 
 }
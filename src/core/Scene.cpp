@@ -2,6 +2,9 @@
 #include <base-logging/Logging.hpp>
 #include "../tasks/JointTask.hpp"
 #include "../tasks/CartesianTask.hpp"
+#include <cxxabi.h>
+#include <typeinfo>
+#include <cstdlib>
 
 namespace wbc{
 
@@ -62,15 +65,31 @@ bool Scene::configure(const std::vector<TaskConfig> &config){
     hqp.resize(tasks.size());
     configured = true;
 
+    // The robot model might have been reconfigured, so drop all information that the constraints have cached about it
+    for(size_t i = 0; i < constraints.size(); i++){
+        for(size_t j = 0; j < constraints[i].size(); j++)
+            constraints[i][j]->reset();
+    }
+
+    // Allocate the solver output once, so that solve() does not have to resize it in every cycle
+    solver_output_joints.resize(robot_model->noOfActuatedJoints());
+    solver_output_joints.names = robot_model->actuatedJointNames();
+    actuated_joint_indices.resize(robot_model->noOfActuatedJoints());
+    for(uint i = 0; i < robot_model->noOfActuatedJoints(); i++)
+        actuated_joint_indices[i] = robot_model->jointIndex(robot_model->actuatedJointNames()[i]);
+
     // Set actuated joint weights to 1 and unactuated joint weight to 0 by default
     joint_weights.resize(robot_model->noOfJoints());
     joint_weights.names = robot_model->jointNames();
     std::fill(joint_weights.elements.begin(), joint_weights.elements.end(), 1);
+    joint_weights_vector.setOnes(robot_model->noOfJoints());
 
     actuated_joint_weights.resize(robot_model->noOfActuatedJoints());
     actuated_joint_weights.names = robot_model->actuatedJointNames();
     std::fill(actuated_joint_weights.elements.begin(), actuated_joint_weights.elements.end(), 1);
 
+    setupTimingStats();
+
     wbc_config = config;
 
     // Check WBC config
@@ -212,6 +231,59 @@ void Scene::setJointWeights(const JointWeights &weights){
 
     for(auto n : actuated_joint_weights.names)
         actuated_joint_weights[n] = joint_weights[n];
+    joint_weights_vector = base::VectorXd::Map(joint_weights.elements.data(), joint_weights.size());
+}
+
+void Scene::setupTimingStats(){
+
+    timing_stats.clear();
+    timing_stats.names = {"dynamics", "hessian_assembly", "solver", "output_conversion"};
+    timing_stats.elements.resize(n_timing_stages);
+
+    constraint_timing_offset.resize(constraints.size());
+    for(size_t i = 0; i < constraints.size(); i++){
+        constraint_timing_offset[i] = timing_stats.size();
+        for(size_t j = 0; j < constraints[i].size(); j++){
+            const Constraint& c = *constraints[i][j];
+            int status;
+            char* demangled = abi::__cxa_demangle(typeid(c).name(), 0, 0, &status);
+            std::string name = status == 0 ? demangled : typeid(c).name();
+            free(demangled);
+            if(name.find("wbc::") == 0)
+                name = name.substr(5);
+            timing_stats.names.push_back("constraint:" + name);
+            timing_stats.elements.push_back(TimingStats());
+        }
+    }
+
+    task_timing_offset.resize(tasks.size());
+    for(size_t i = 0; i < tasks.size(); i++){
+        task_timing_offset[i] = timing_stats.size();
+        for(size_t j = 0; j < tasks[i].size(); j++){
+            timing_stats.names.push_back("task:" + tasks[i][j]->config.name);
+            timing_stats.elements.push_back(TimingStats());
+        }
+    }
+}
+
+void Scene::addTaskToCost(const Task& task, Eigen::Ref<base::MatrixXd> H, Eigen::Ref<base::VectorXd> g){
+    for(const auto &ri : task.active_column_ranges){
+        for(const auto &rj : task.active_column_ranges)
+            H.block(ri.first, rj.first, ri.second, rj.second).noalias() += task.Aw.middleCols(ri.first, ri.second).transpose() * task.Aw.middleCols(rj.first, rj.second);
+        g.segment(ri.first, ri.second).noalias() -= task.Aw.middleCols(ri.first, ri.second).transpose() * task.y_ref_root;
+    }
+}
+
+void Scene::weightTask(Task& task){
+    const double w = task.activation * (!task.timeout);
+    for(const auto &r : task.active_column_ranges)
+        task.Aw.middleCols(r.first, r.second).noalias() = (w * task.weights_root).asDiagonal() * task.A.middleCols(r.first, r.second)
+                                                          * joint_weights_vector.segment(r.first, r.second).asDiagonal();
+}
+
+void Scene::resetTimingStats(){
+    for(auto &t : timing_stats.elements)
+        t.reset();
 }
 
 SceneFactory::SceneMap* SceneFactory::scene_map = 0;
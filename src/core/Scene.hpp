@@ -7,6 +7,7 @@
 #include "RobotModel.hpp"
 #include "QPSolver.hpp"
 #include "SceneConfig.hpp"
+#include "TimingStats.hpp"
 
 namespace wbc{
 
@@ -24,10 +25,49 @@ protected:
     std::vector<int> n_task_variables_per_prio;
     bool configured;
     base::commands::Joints solver_output_joints;
+    std::vector<uint> actuated_joint_indices; /** Index of each actuated joint in the joint vector of the robot model, computed in configure()*/
     JointWeights joint_weights, actuated_joint_weights;
+    base::VectorXd joint_weights_vector; /** Same as joint_weights, as plain vector for efficient use in the control loop*/
     std::vector<TaskConfig> wbc_config;
     base::VectorXd solver_output;
 
+    /** Stages of the scene update/solve cycle, whose execution times are recorded in timing_stats. In addition, there is one entry for each
+     *  constraint and each task, see constraintTiming() and taskTiming()*/
+    enum TimingStage{
+        timing_dynamics = 0,          /** Evaluation of the joint space inertia matrix and bias forces, which are shared by multiple constraints (only in the TSID scenes).
+                                          Robot model queries of the individual constraints and tasks (e.g. Jacobians) are included in their own entries*/
+        timing_hessian_assembly,      /** Assembly of Hessian and gradient (or task matrices for the HLS scene) from the task matrices*/
+        timing_solver,                /** Solver call*/
+        timing_output_conversion,     /** Conversion of the raw solver output to joint commands*/
+        n_timing_stages
+    };
+    TimingsStats timing_stats;
+    std::vector<uint> constraint_timing_offset, task_timing_offset;
+
+    /** @brief Return the timing entry for the i-th constraint of the given priority*/
+    TimingStats& constraintTiming(uint prio, uint i){return timing_stats[constraint_timing_offset[prio] + i];}
+
+    /** @brief Return the timing entry for the i-th task of the given priority*/
+    TimingStats& taskTiming(uint prio, uint i){return timing_stats[task_timing_offset[prio] + i];}
+
+    /** @brief Create one timing entry for each stage, each constraint and each task. Called in configure()*/
+    void setupTimingStats();
+
+    /**
+     * @brief Add the weighted task matrix to the cost function, i.e. H += Aw^T*Aw and g -= Aw^T*y_ref_root. Only the sub-blocks of H and g that correspond to
+     *  the active column ranges of the task are updated, since all other columns of Aw are zero.
+     * @param task The task. Aw and y_ref_root have to be up to date
+     * @param H Hessian, size nj x nj, where nj is the number of robot joints. Can be a block of a larger matrix
+     * @param g Gradient vector, size nj. Can be a segment of a larger vector
+     */
+    static void addTaskToCost(const Task& task, Eigen::Ref<base::MatrixXd> H, Eigen::Ref<base::VectorXd> g);
+
+    /**
+     * @brief Compute the weighted task matrix Aw = diag(w) * A * diag(Wq), where w are the task weights in root coordinates multiplied by the task activation
+     *  (and zero if the task is in timeout) and Wq the joint weights. Only the active column ranges of the task are computed.
+     */
+    void weightTask(Task& task);
+
     /**
      * brief Create a task and add it to the WBC scene
      */
@@ -101,6 +141,17 @@ public:
      */
     const TasksStatus& getTasksStatus() const { return tasks_status; }
 
+    /**
+     * @brief Return the execution times of all stages of the update/solve cycle. The entries are named "dynamics", "hessian_assembly",
+     *  "solver", "output_conversion", "constraint:<constraint type>" and "task:<task name>". Valid after configure()
+     */
+    const TimingsStats& getTimingStats() const { return timing_stats; }
+
+    /**
+     * @brief Remove all samples from the timing stats
+     */
+    void resetTimingStats();
+
     /**
      * @brief Sort task config by the priorities of the tasks
      */
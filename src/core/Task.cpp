@@ -1,6 +1,7 @@
 #include "Task.hpp"
 #include <base-logging/Logging.hpp>
 #include <base/Float.hpp>
+#include <algorithm>
 
 namespace wbc{
 
@@ -20,6 +21,7 @@ Task::Task(const TaskConfig& _config, uint n_robot_joints) :
 
     A.resize(no_variables, n_robot_joints);
     Aw.resize(no_variables, n_robot_joints);
+    active_column_ranges = {std::make_pair(0u, n_robot_joints)};
     reset();
 }
 
@@ -66,6 +68,24 @@ void Task::setWeights(const base::VectorXd& weights){
     this->weights = weights;
 }
 
+void Task::setActiveColumns(std::vector<uint> columns){
+
+    std::sort(columns.begin(), columns.end());
+    columns.erase(std::unique(columns.begin(), columns.end()), columns.end());
+    if(!columns.empty() && columns.back() >= A.cols()){
+        LOG_ERROR("Task %s: Active column %i is out of range, the task matrix has only %i columns", config.name.c_str(), columns.back(), A.cols());
+        throw std::invalid_argument("Invalid active columns");
+    }
+
+    active_column_ranges.clear();
+    for(uint c : columns){
+        if(!active_column_ranges.empty() && active_column_ranges.back().first + active_column_ranges.back().second == c)
+            active_column_ranges.back().second++;
+        else
+            active_column_ranges.push_back(std::make_pair(c, 1));
+    }
+}
+
 void Task::setActivation(const double activation){
     if(activation < 0 || activation > 1){
         LOG_ERROR("Task %s: Activation has to be between 0 and 1 but is %f", config.name.c_str(), activation);
@@ -52,6 +52,12 @@ public:
      */
     void setActivation(const double activation);
 
+    /**
+     * @brief Set the columns of the task matrix that can contain non-zero entries. All other columns of A are assumed to be zero.
+     * @param columns Column indices. Have to be smaller than the number of robot joints.
+     */
+    void setActiveColumns(std::vector<uint> columns);
+
     /** Last time the task reference values was updated.*/
     base::Time time;
 
@@ -87,6 +93,10 @@ public:
 
     /** Weighted task matrix */
     base::MatrixXd Aw;
+
+    /** Contiguous column ranges (first column, number of columns) of A that can contain non-zero entries, in ascending order. All other columns of A are zero, so that
+     *  e.g. the Hessian A^T*A only has to be computed on the corresponding sub-blocks. Default is a single range covering all columns. See setActiveColumns()*/
+    std::vector< std::pair<uint,uint> > active_column_ranges;
 };
 
 
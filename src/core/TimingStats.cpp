@@ -0,0 +1,46 @@
+#include "TimingStats.hpp"
+#include <base/Float.hpp>
+#include <algorithm>
+#include <stdexcept>
+
+namespace wbc{
+
+TimingStats::TimingStats(uint window_size) :
+    window(window_size),
+    sorted(window_size){
+    if(window_size == 0)
+        throw std::invalid_argument("TimingStats: Window size has to be > 0");
+    reset();
+}
+
+void TimingStats::add(double t){
+    last = t;
+    if(n_samples == 0)
+        min = max = mean = t;
+    else{
+        min = std::min(min, t);
+        max = std::max(max, t);
+    }
+    n_samples++;
+    mean += (t - mean) / n_samples;
+
+    window[window_pos] = t;
+    window_pos = (window_pos + 1) % window.size();
+}
+
+void TimingStats::reset(){
+    n_samples = window_pos = 0;
+    last = min = max = mean = base::NaN<double>();
+}
+
+double TimingStats::percentile(double p) const{
+    uint n = std::min<size_t>(n_samples, window.size());
+    if(n == 0)
+        return base::NaN<double>();
+    std::copy(window.begin(), window.begin() + n, sorted.begin());
+    uint k = std::min<uint>(n - 1, (uint)(std::max(0.0, std::min(1.0, p)) * n));
+    std::nth_element(sorted.begin(), sorted.begin() + k, sorted.begin() + n);
+    return sorted[k];
+}
+
+} // namespace wbc
@@ -0,0 +1,59 @@
+#ifndef WBC_CORE_TIMING_STATS_HPP
+#define WBC_CORE_TIMING_STATS_HPP
+
+#include <base/NamedVector.hpp>
+#include <chrono>
+#include <vector>
+
+namespace wbc{
+
+/**
+ * @brief Aggregated execution time of a single processing stage of a WBC scene (e.g. a task update or the solver call). All
+ *  times are in seconds. min/max/mean are computed over all samples since the last reset(), the percentiles over a sliding window
+ *  of the most recent samples. Adding a sample does not allocate memory, so this can be used within the control loop.
+ */
+class TimingStats{
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    TimingStats(uint window_size = 1000);
+
+    /** @brief Add a new sample (execution time in seconds)*/
+    void add(double t);
+
+    /** @brief Add the time elapsed since the given time point as new sample*/
+    void add(const Clock::time_point& start){add(elapsed(start));}
+
+    /** @brief Return the time elapsed since the given time point in seconds*/
+    static double elapsed(const Clock::time_point& start){return std::chrono::duration<double>(Clock::now() - start).count();}
+
+    /** @brief Remove all samples*/
+    void reset();
+
+    /** @brief Return the p-th percentile (p in [0,1]) of the samples in the sliding window. Returns NaN if there are no samples*/
+    double percentile(double p) const;
+
+    /** @brief Return the 99th percentile of the samples in the sliding window*/
+    double p99() const {return percentile(0.99);}
+
+    uint n_samples;     /** Number of samples since the last reset*/
+    double last;        /** Last sample*/
+    double min;         /** Minimum of all samples*/
+    double max;         /** Maximum of all samples*/
+    double mean;        /** Mean of all samples*/
+
+private:
+    std::vector<double> window;             /** Ring buffer containing the most recent samples*/
+    uint window_pos;                        /** Next write position in the ring buffer*/
+    mutable std::vector<double> sorted;     /** Scratch buffer for percentile computation*/
+};
+
+/**
+ * @brief Execution times of all processing stages of a WBC scene, by stage name
+ */
+class TimingsStats : public base::NamedVector<TimingStats>{
+};
+
+} // namespace wbc
+
+#endif
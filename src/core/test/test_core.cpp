@@ -100,6 +100,43 @@ BOOST_AUTO_TEST_CASE(qp_solver_factory){
     BOOST_CHECK(model != 0);
 }
 
+/** Dummy solver that takes a fixed time per iteration, to test the time budget of the QPSolver base class*/
+class BudgetTestSolver : public QPSolver{
+public:
+    virtual void solve(const HierarchicalQP& hierarchical_qp, base::VectorXd &solver_output){
+        SolveTimer timer(stats);
+        stats.n_iter = budgetedMaxIter(1000);
+        updateTimePerIteration(stats.n_iter * 1e-6, stats.n_iter);
+        stats.budget_exceeded = stats.n_iter < 1000;
+    }
+};
+
+BOOST_AUTO_TEST_CASE(qp_solver_time_budget){
+    BudgetTestSolver solver;
+    HierarchicalQP hqp;
+    base::VectorXd solver_output;
+
+    BOOST_CHECK(solver.getTimeBudget() == 0);
+    BOOST_CHECK_THROW(solver.setTimeBudget(-1), std::invalid_argument);
+
+    // No budget: Iterations are not limited
+    solver.solve(hqp, solver_output);
+    BOOST_CHECK(solver.getStats().n_iter == 1000);
+    BOOST_CHECK(!solver.getStats().budget_exceeded);
+    BOOST_CHECK(solver.getStats().solve_time >= 0);
+
+    // Budget of 100 iterations
+    solver.setTimeBudget(1.005e-4);
+    solver.solve(hqp, solver_output);
+    BOOST_CHECK(solver.getStats().n_iter == 100);
+    BOOST_CHECK(solver.getStats().budget_exceeded);
+
+    // At least one iteration is always performed
+    solver.setTimeBudget(1e-9);
+    solver.solve(hqp, solver_output);
+    BOOST_CHECK(solver.getStats().n_iter == 1);
+}
+
 BOOST_AUTO_TEST_CASE(scene_factory){
     BOOST_CHECK_NO_THROW(PluginLoader::loadPlugin("libwbc-scenes-velocity.so"));
     SceneFactory::SceneMap *scene_map = SceneFactory::getSceneMap();
@@ -2,6 +2,12 @@
 #include <base-logging/Logging.hpp>
 #include <urdf_parser/urdf_parser.h>
 #include <tools/URDFTools.hpp>
+#include <unistd.h>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <numeric>
+#include <algorithm>
 
 namespace wbc{
 
@@ -18,6 +24,7 @@ void RobotModelHyrodyn::clear(){
     RobotModel::clear();
 
     hyrodyn = hyrodyn::RobotModel_HyRoDyn();
+    independent_joint_in_indices.clear();
 }
 
 bool RobotModelHyrodyn::configure(const RobotModelConfig& cfg){
@@ -46,17 +53,31 @@ bool RobotModelHyrodyn::configure(const RobotModelConfig& cfg){
     // Read Joint Limits
     URDFTools::jointLimitsFromURDF(robot_urdf, joint_limits);
 
-    TiXmlDocument *doc = urdf::exportURDF(robot_urdf);
-    std::string robot_urdf_file = "/tmp/floating_base_model.urdf";
-    doc->SaveFile(robot_urdf_file);
+    // Hyrodyn can only load models from file. Use a unique temporary file for each call, so that multiple models can be configured concurrently
+    char robot_urdf_file[] = "/tmp/wbc_hyrodyn_XXXXXX.urdf";
+    int fd = mkstemps(robot_urdf_file, 5);
+    if(fd < 0){
+        LOG_ERROR_S << "Failed to create temporary URDF file " << robot_urdf_file << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+    std::string robot_urdf_string = URDFTools::URDFToString(robot_urdf);
+    bool write_ok = write(fd, robot_urdf_string.c_str(), robot_urdf_string.size()) == (ssize_t)robot_urdf_string.size();
+    close(fd);
+    if(!write_ok){
+        LOG_ERROR_S << "Failed to write temporary URDF file " << robot_urdf_file << std::endl;
+        std::remove(robot_urdf_file);
+        return false;
+    }
     try{
         hyrodyn.load_robotmodel(robot_urdf_file, cfg.submechanism_file);
     }
     catch(std::exception e){
-        LOG_ERROR_S << "Failed to load hyrodyn model from URDF " << robot_urdf_file <<
+        LOG_ERROR_S << "Failed to load hyrodyn model from URDF " << cfg.file_or_string <<
                        " and submechanism file " << cfg.submechanism_file << std::endl;
+        std::remove(robot_urdf_file);
         return false;
     }
+    std::remove(robot_urdf_file);
 
     joint_state.names = hyrodyn.jointnames_spanningtree;
     joint_state.elements.resize(hyrodyn.jointnames_spanningtree.size());
@@ -105,9 +126,43 @@ bool RobotModelHyrodyn::configure(const RobotModelConfig& cfg){
     return true;
 }
 
+void RobotModelHyrodyn::setIndependentJoint(uint i, const base::JointState& state){
+    // With floating base, the first 6 independent joints are the floating base joints, which are not part of y
+    if(has_floating_base){
+        hyrodyn.y_robot[i-6]   = state.position;
+        hyrodyn.yd_robot[i-6]  = state.speed;
+        hyrodyn.ydd_robot[i-6] = state.acceleration;
+    }
+    else{
+        hyrodyn.y[i]   = state.position;
+        hyrodyn.yd[i]  = state.speed;
+        hyrodyn.ydd[i] = state.acceleration;
+    }
+}
+
+void RobotModelHyrodyn::bindJointStateLayout(const std::vector<std::string> &names){
+    // Hyrodyn is updated from the independent joints, which differ from the actuated joints for robots with parallel mechanisms
+    const uint start_idx = has_floating_base ? 6 : 0;
+    independent_joint_in_indices.resize(hyrodyn.jointnames_independent.size());
+    for(size_t i = start_idx; i < hyrodyn.jointnames_independent.size(); i++){
+        const std::string &name = hyrodyn.jointnames_independent[i];
+        size_t idx = std::find(names.begin(), names.end(), name) - names.begin();
+        if(idx >= names.size()){
+            LOG_ERROR_S << "Joint " << name << " is in independent joints of Hyrodyn model, but it is not in the joint state layout" << std::endl;
+            throw std::runtime_error("Incomplete Joint State");
+        }
+        independent_joint_in_indices[i] = idx;
+    }
+    joint_state_in_names = names;
+    joint_state_layout_bound = true;
+    joint_state_layout_explicit = true;
+}
+
 void RobotModelHyrodyn::update(const base::samples::Joints& joint_state_in,
                                const base::samples::RigidBodyStateSE3& _floating_base_state){
 
+    invalidateCache();
+
     if(joint_state_in.elements.size() != joint_state_in.names.size()){
         LOG_ERROR_S << "Size of names and size of elements in joint state do not match"<<std::endl;
         throw std::runtime_error("Invalid joint state");
@@ -118,6 +173,45 @@ void RobotModelHyrodyn::update(const base::samples::Joints& joint_state_in,
         throw std::runtime_error("Invalid joint state");
     }
 
+    const uint start_idx = has_floating_base ? 6 : 0;
+    for(unsigned int i = start_idx; i < hyrodyn.jointnames_independent.size(); ++i){
+        const std::string& name =  hyrodyn.jointnames_independent[i];
+        try{
+            setIndependentJoint(i, joint_state_in[name]);
+        }
+        catch(base::samples::Joints::InvalidName e){
+            LOG_ERROR_S << "Joint " << name << " is in independent joints of Hyrodyn model, but it is not given in joint state vector" << std::endl;
+            throw e;
+        }
+    }
+    updateSystemState(joint_state_in.time, _floating_base_state);
+}
+
+void RobotModelHyrodyn::update(const base::VectorXd& q, const base::VectorXd& qd, const base::VectorXd& qdd, const base::Time& time,
+                               const base::samples::RigidBodyStateSE3& _floating_base_state){
+
+    invalidateCache();
+    checkRawJointState(q, qd, qdd);
+
+    if(time.isNull()){
+        LOG_ERROR_S << "Joint State does not have a valid timestamp. Or do we have 1970?"<<std::endl;
+        throw std::runtime_error("Invalid joint state");
+    }
+
+    const uint start_idx = has_floating_base ? 6 : 0;
+    base::JointState state;
+    for(unsigned int i = start_idx; i < hyrodyn.jointnames_independent.size(); ++i){
+        const uint idx = independent_joint_in_indices[i];
+        state.position = q[idx];
+        state.speed = qd[idx];
+        state.acceleration = qdd[idx];
+        setIndependentJoint(i, state);
+    }
+    updateSystemState(time, _floating_base_state);
+}
+
+void RobotModelHyrodyn::updateSystemState(const base::Time& time, const base::samples::RigidBodyStateSE3& _floating_base_state){
+
     if(has_floating_base){
         if(!_floating_base_state.hasValidPose() ||
            !_floating_base_state.hasValidTwist() ||
@@ -155,45 +249,19 @@ void RobotModelHyrodyn::update(const base::samples::Joints& joint_state_in,
         hyrodyn.floating_robot_accn.segment(0,3) = fb_acc.angular;
         hyrodyn.floating_robot_accn.segment(3,3) = fb_acc.linear;
 
-        for( unsigned int i = 6; i < hyrodyn.jointnames_independent.size(); ++i){
-            const std::string& name =  hyrodyn.jointnames_independent[i];
-            try{
-                hyrodyn.y_robot[i-6]   = joint_state_in[name].position;
-                hyrodyn.yd_robot[i-6]  = joint_state_in[name].speed;
-                hyrodyn.ydd_robot[i-6] = joint_state_in[name].acceleration;
-            }
-            catch(base::samples::Joints::InvalidName e){
-                LOG_ERROR_S << "Joint " << name << " is in independent joints of Hyrodyn model, but it is not given in joint state vector" << std::endl;
-                throw e;
-            }
-        }
         hyrodyn.update_all_independent_coordinates();
     }
-    else{
-        for( unsigned int i = 0; i < hyrodyn.jointnames_independent.size(); ++i){
-            const std::string& name =  hyrodyn.jointnames_independent[i];
-            try{
-                hyrodyn.y[i]   = joint_state_in[name].position;
-                hyrodyn.yd[i]  = joint_state_in[name].speed;
-                hyrodyn.ydd[i] = joint_state_in[name].acceleration;
-            }
-            catch(base::samples::Joints::InvalidName e){
-                LOG_ERROR_S << "Joint " << name << " is in independent joints of Hyrodyn model, but it is not given in joint state vector" << std::endl;
-                throw e;
-            }
-        }
-    }
 
     // Compute system state
     hyrodyn.calculate_system_state();
 
+    // The joint order of joint_state is the spanning tree order of Hyrodyn, see configure()
     for(size_t i = 0; i < hyrodyn.jointnames_spanningtree.size(); i++){
-        const std::string &name = hyrodyn.jointnames_spanningtree[i];
-        joint_state[name].position = hyrodyn.Q[i];
-        joint_state[name].speed = hyrodyn.QDot[i];
-        joint_state[name].acceleration = hyrodyn.QDDot[i];
+        joint_state.elements[i].position = hyrodyn.Q[i];
+        joint_state.elements[i].speed = hyrodyn.QDot[i];
+        joint_state.elements[i].acceleration = hyrodyn.QDDot[i];
     }
-    joint_state.time = joint_state_in.time;
+    joint_state.time = time;
 }
 
 void RobotModelHyrodyn::systemState(base::VectorXd &_q, base::VectorXd &_qd, base::VectorXd &_qdd){
@@ -328,9 +396,13 @@ const base::MatrixXd &RobotModelHyrodyn::comJacobian(){
         throw std::runtime_error(" Invalid call to comJacobian()");
     }
 
+    if(com_jac_valid)
+        return com_jac;
+
     hyrodyn.calculate_com_jacobian();
     com_jac.resize(3,noOfJoints());
     com_jac = hyrodyn.Jcom;
+    com_jac_valid = true;
     return com_jac;
 }
 
@@ -339,6 +411,13 @@ const base::MatrixXd &RobotModelHyrodyn::jacobianDot(const std::string &root_fra
     throw std::runtime_error("Not implemented: jacobianDot has not been implemented for RobotModelHyrodyn");
 }
 
+std::vector<uint> RobotModelHyrodyn::chainJointIndices(uint chain_handle){
+    chain(chain_handle); // Check validity of the handle
+    std::vector<uint> indices(noOfJoints());
+    std::iota(indices.begin(), indices.end(), 0);
+    return indices;
+}
+
 const base::Acceleration &RobotModelHyrodyn::spatialAccelerationBias(const std::string &root_frame, const std::string &tip_frame){
     hyrodyn.calculate_spatial_acceleration_bias(tip_frame);
     spatial_acc_bias = base::Acceleration(hyrodyn.spatial_acceleration_bias.segment(3,3), hyrodyn.spatial_acceleration_bias.segment(0,3));
@@ -351,6 +430,9 @@ const base::MatrixXd &RobotModelHyrodyn::jointSpaceInertiaMatrix(){
         throw std::runtime_error(" Invalid call to jointSpaceInertiaMatrix()");
     }
 
+    if(joint_space_inertia_mat_valid)
+        return joint_space_inertia_mat;
+
     // Compute joint space inertia matrix
     if(hyrodyn.floating_base_robot){
         hyrodyn.calculate_mass_interia_matrix_actuation_space_including_floatingbase();
@@ -361,6 +443,7 @@ const base::MatrixXd &RobotModelHyrodyn::jointSpaceInertiaMatrix(){
         joint_space_inertia_mat = hyrodyn.Hu;
     }
 
+    joint_space_inertia_mat_valid = true;
     return joint_space_inertia_mat;
 }
 
@@ -370,6 +453,9 @@ const base::VectorXd &RobotModelHyrodyn::biasForces(){
         throw std::runtime_error(" Invalid call to biasForces()");
     }
 
+    if(bias_forces_valid)
+        return bias_forces;
+
     // Compute bias forces
     hyrodyn.ydd.setZero();
     if(hyrodyn.floating_base_robot){
@@ -381,10 +467,14 @@ const base::VectorXd &RobotModelHyrodyn::biasForces(){
         bias_forces = hyrodyn.Tau_actuated;
     }
 
+    bias_forces_valid = true;
     return bias_forces;
 }
 
 const base::samples::RigidBodyStateSE3& RobotModelHyrodyn::centerOfMass(){
+    if(com_valid)
+        return com_rbs;
+
     hyrodyn.calculate_com_properties();
 
     com_rbs.frame_id = world_frame;
@@ -395,6 +485,7 @@ const base::samples::RigidBodyStateSE3& RobotModelHyrodyn::centerOfMass(){
     com_rbs.acceleration.linear = hyrodyn.com_acc; // TODO: double check CoM acceleration
     com_rbs.acceleration.angular.setZero();
     com_rbs.time = joint_state.time;
+    com_valid = true;
     return com_rbs;
 }
 
@@ -15,7 +15,15 @@ private:
 protected:
     hyrodyn::RobotModel_HyRoDyn hyrodyn;
 
+    std::vector<uint> independent_joint_in_indices; /** Index of each independent joint of Hyrodyn in the bound input joint state layout*/
+
     void clear();
+
+    /** Set position, velocity and acceleration of the i-th independent joint of Hyrodyn*/
+    void setIndependentJoint(uint i, const base::JointState& state);
+
+    /** Update the floating base and compute the system state of Hyrodyn from the independent joints that have been set before*/
+    void updateSystemState(const base::Time& time, const base::samples::RigidBodyStateSE3& floating_base_state);
 public:
     RobotModelHyrodyn();
     virtual ~RobotModelHyrodyn();
@@ -35,6 +43,19 @@ public:
     virtual void update(const base::samples::Joints& joint_state,
                         const base::samples::RigidBodyStateSE3& floating_base_state = base::samples::RigidBodyStateSE3());
 
+    /**
+     * @brief Update the robot configuration from raw joint position, velocity and acceleration vectors. The entries have to be in the order given to bindJointStateLayout().
+     *        The independent joints of Hyrodyn are read from the vectors using the indices computed in bindJointStateLayout().
+     */
+    virtual void update(const base::VectorXd& q, const base::VectorXd& qd, const base::VectorXd& qdd, const base::Time& time,
+                        const base::samples::RigidBodyStateSE3& floating_base_state = base::samples::RigidBodyStateSE3());
+
+    /**
+     * @brief Bind the joint order of the raw joint vectors passed to update(). Has to contain all independent joints of the Hyrodyn model, which
+     *        differ from the actuated joints for robots with parallel mechanisms.
+     */
+    virtual void bindJointStateLayout(const std::vector<std::string> &joint_names);
+
     /** Return entire system state*/
     virtual void systemState(base::VectorXd &q, base::VectorXd &qd, base::VectorXd &qdd);
 
@@ -83,6 +104,10 @@ public:
       */
     virtual const base::Acceleration &spatialAccelerationBias(const std::string &root_frame, const std::string &tip_frame);
 
+    /** @brief Return all joint indices. In models with parallel mechanisms, the actuated joints are not necessarily on the path between root and tip
+      * in the URDF tree, so no column of the Jacobians can be excluded*/
+    virtual std::vector<uint> chainJointIndices(uint chain_handle);
+
     /** Compute and return the joint space mass-inertia matrix, which is nj x nj, where nj is the number of joints of the system*/
     virtual const base::MatrixXd &jointSpaceInertiaMatrix();
 
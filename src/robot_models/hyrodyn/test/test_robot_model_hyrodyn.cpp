@@ -233,3 +233,41 @@ BOOST_AUTO_TEST_CASE(compare_serial_vs_hybrid_model){
     for(int i = 0; i < robot_model_hybrid.noOfActuatedJoints(); i++)
         BOOST_CHECK(fabs(robot_model_hybrid.hyrodynHandle()->yd[i] - yd[i]) < 1e-6);
 }
+
+BOOST_AUTO_TEST_CASE(raw_update_hybrid_model){
+
+    /**
+     * Verify that updating a series-parallel hybrid robot model from raw joint vectors in a bound (permuted) joint layout gives the same result as
+     * updating from a named joint state. The independent joints of this model differ from the actuated joints
+     */
+
+    string root = "RH5_Root_Link";
+    string tip  = "LLAnklePitch_Link";
+
+    RobotModelHyrodyn robot_model;
+    RobotModelConfig config("../../../../../models/rh5/urdf/rh5_single_leg_hybrid.urdf");
+    config.submechanism_file = "../../../../../models/rh5/hyrodyn/rh5_single_leg_hybrid.yml";
+    BOOST_CHECK(robot_model.configure(config) == true);
+
+    base::samples::Joints joint_state = makeRandomJointState(robot_model.hyrodynHandle()->jointnames_independent);
+    BOOST_CHECK_NO_THROW(robot_model.update(joint_state));
+    base::samples::RigidBodyStateSE3 rbs = robot_model.rigidBodyState(root, tip);
+
+    vector<string> layout(joint_state.names.rbegin(), joint_state.names.rend());
+    uint n = layout.size();
+    base::VectorXd q(n), qd(n), qdd(n);
+    for(uint i = 0; i < n; i++){
+        q[i]   = joint_state[layout[i]].position;
+        qd[i]  = joint_state[layout[i]].speed;
+        qdd[i] = joint_state[layout[i]].acceleration;
+    }
+
+    BOOST_CHECK_THROW(robot_model.bindJointStateLayout(vector<string>(layout.begin()+1, layout.end())), std::runtime_error);
+    robot_model.bindJointStateLayout(layout);
+    BOOST_CHECK_NO_THROW(robot_model.update(q, qd, qdd, joint_state.time));
+
+    const base::samples::RigidBodyStateSE3 &rbs_raw = robot_model.rigidBodyState(root, tip);
+    BOOST_CHECK(rbs.pose.position.isApprox(rbs_raw.pose.position));
+    BOOST_CHECK(rbs.twist.linear.isApprox(rbs_raw.twist.linear));
+    BOOST_CHECK(rbs.acceleration.linear.isApprox(rbs_raw.acceleration.linear));
+}
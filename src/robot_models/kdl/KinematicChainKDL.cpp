@@ -46,19 +46,26 @@ const base::samples::RigidBodyStateSE3 &KinematicChainKDL::rigidBodyState(){
     return cartesian_state;
 }
 
-void KinematicChainKDL::update(const KDL::JntArray& q, const KDL::JntArray& qd, const KDL::JntArray& qdd, std::map<std::string,int> joint_idx_map){
-
-    //// update Joints
-    for(size_t i = 0; i < joint_names.size(); i++){
-        const std::string& name = joint_names[i];
-        if(joint_idx_map.count(name) == 0){
-            LOG_ERROR("Kinematic Chain %s to %s contains joint %s, but this joint is not in joint state vector",
-                      chain.getSegment(0).getName().c_str(), chain.getSegment(chain.getNrOfSegments()-1).getName().c_str(), joint_names[i].c_str());
-            throw std::invalid_argument("Invalid joint state");
+void KinematicChainKDL::update(const KDL::JntArray& q, const KDL::JntArray& qd, const KDL::JntArray& qdd, const std::map<std::string,int>& joint_idx_map){
+
+    // Look up the joint indices only once
+    if(joint_idx.size() != joint_names.size()){
+        joint_idx.resize(joint_names.size());
+        for(size_t i = 0; i < joint_names.size(); i++){
+            auto it = joint_idx_map.find(joint_names[i]);
+            if(it == joint_idx_map.end()){
+                joint_idx.clear();
+                LOG_ERROR("Kinematic Chain %s to %s contains joint %s, but this joint is not in joint state vector",
+                          chain.getSegment(0).getName().c_str(), chain.getSegment(chain.getNrOfSegments()-1).getName().c_str(), joint_names[i].c_str());
+                throw std::invalid_argument("Invalid joint state");
+            }
+            joint_idx[i] = it->second;
         }
+    }
 
-        uint idx = joint_idx_map[name];
-
+    //// update Joints
+    for(size_t i = 0; i < joint_idx.size(); i++){
+        uint idx = joint_idx[i];
         jnt_array_vel.q(i)       = jnt_array_acc.q(i)    = q(idx);
         jnt_array_vel.qdot(i)    = jnt_array_acc.qdot(i) = qd(idx);
         jnt_array_acc.qdotdot(i) = qdd(idx);
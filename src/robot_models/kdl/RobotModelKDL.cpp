@@ -98,6 +98,9 @@ bool RobotModelKDL::configure(const RobotModelConfig& cfg){
         if(jnt.getType() != KDL::Joint::None)
             joint_idx_map_kdl[jnt.getName()] = GetTreeElementQNr(it.second);
     }
+    actuated_joint_idx_kdl.resize(actuated_joint_names.size());
+    for(size_t i = 0; i < actuated_joint_names.size(); i++)
+        actuated_joint_idx_kdl[i] = joint_idx_map_kdl[actuated_joint_names[i]];
 
     // 5. Print some debug info
 
@@ -144,19 +147,8 @@ void RobotModelKDL::createChain(const KDL::Tree& tree, const std::string &root_f
 void RobotModelKDL::update(const base::samples::Joints& joint_state_in,
                            const base::samples::RigidBodyStateSE3& _floating_base_state){
 
-    if(joint_state_in.elements.size() != joint_state_in.names.size()){
-        LOG_ERROR_S << "Size of names and size of elements in joint state do not match"<<std::endl;
-        throw std::runtime_error("Invalid joint state");
-    }
-
-    if(joint_state_in.time.isNull()){
-        LOG_ERROR_S << "Joint State does not have a valid timestamp. Or do we have 1970?"<<std::endl;
-        throw std::runtime_error("Invalid joint state");
-    }
-
-    for(auto n : actuated_joint_names)
-        joint_state[n] = joint_state_in[n];
-    joint_state.time = joint_state_in.time;
+    invalidateCache();
+    updateJointState(joint_state_in);
 
     // Update floating base if available
     if(has_floating_base){
@@ -172,35 +164,30 @@ void RobotModelKDL::update(const base::samples::Joints& joint_state_in,
         }
         floating_base_state = _floating_base_state;
         base::Vector3d euler = floating_base_state.pose.orientation.toRotationMatrix().eulerAngles(0, 1, 2);
+        // The floating base joints are the first 6 entries in joint_state
         for(int i = 0; i < 3; i++){
-            q(i)   = joint_state[joint_names_floating_base[i]].position     = floating_base_state.pose.position(i);
-            qd(i)  = joint_state[joint_names_floating_base[i]].speed        = floating_base_state.twist.linear(i);
-            qdd(i) = joint_state[joint_names_floating_base[i]].acceleration = floating_base_state.acceleration.linear(i);
+            q(i)   = joint_state.elements[i].position     = floating_base_state.pose.position(i);
+            qd(i)  = joint_state.elements[i].speed        = floating_base_state.twist.linear(i);
+            qdd(i) = joint_state.elements[i].acceleration = floating_base_state.acceleration.linear(i);
 
-            q(i+3)   = joint_state[joint_names_floating_base[i+3]].position     = euler(i);
-            qd(i+3)  = joint_state[joint_names_floating_base[i+3]].speed        = floating_base_state.twist.angular(i);
-            qdd(i+3) = joint_state[joint_names_floating_base[i+3]].acceleration = floating_base_state.acceleration.angular(i);
+            q(i+3)   = joint_state.elements[i+3].position     = euler(i);
+            qd(i+3)  = joint_state.elements[i+3].speed        = floating_base_state.twist.angular(i);
+            qdd(i+3) = joint_state.elements[i+3].acceleration = floating_base_state.acceleration.angular(i);
         }
         if(floating_base_state.time > joint_state.time)
             joint_state.time = floating_base_state.time;
     }
 
-    // Update actuated joints
-    for(size_t i = 0; i < noOfActuatedJoints(); i++){
-        const std::string &name = actuated_joint_names[i];
-        if(!hasJoint(name)){
-            LOG_ERROR_S << "Joint " << name << " is a non-fixed joint in the KDL Tree, but it is not in the joint state vector."
-                        << "You should either set the joint to 'fixed' in your URDF file or provide a valid joint state for it" << std::endl;
-            throw std::runtime_error("Incomplete Joint State");
-        }
-        const base::JointState &state = joint_state_in[name];
-        uint idx = joint_idx_map_kdl[name];
+    // Update actuated joints. Indices in the KDL joint arrays have been computed in configure()
+    for(size_t i = 0; i < actuated_joint_indices.size(); i++){
+        const base::JointState &state = joint_state.elements[actuated_joint_indices[i]];
+        uint idx = actuated_joint_idx_kdl[i];
         q(idx) = state.position;
         qd(idx) = state.speed;
         qdd(idx) = state.acceleration;
     }
 
-    for(auto c : kdl_chain_map)
+    for(auto &c : kdl_chain_map)
         c.second->update(q,qd,qdd,joint_idx_map_kdl);
 }
 
@@ -297,6 +284,9 @@ const base::MatrixXd &RobotModelKDL::comJacobian(){
         throw std::runtime_error(" Invalid call to rigidBodyState()");
     }
 
+    if(com_jac_valid)
+        return com_jac;
+
     com_jac = base::MatrixXd::Zero(3, noOfJoints());
 
     // create a copy in which, for each segment with mass, COG frames are added
@@ -335,6 +325,7 @@ const base::MatrixXd &RobotModelKDL::comJacobian(){
         com_jac += (mass_map[segment_name] / totalMass) *
             spaceJacobianFromTree(tree_cog_frames, tree_cog_frames.getRootSegment()->second.segment.getName(), segment_name).topRows<3>();
 
+    com_jac_valid = true;
     return com_jac;
 }
 
@@ -379,6 +370,9 @@ const base::VectorXd &RobotModelKDL::biasForces(){
         throw std::runtime_error(" Invalid call to jacobianDot()");
     }
 
+    if(bias_forces_valid)
+        return bias_forces;
+
     // Use ID solver with zero joint accelerations and zero external wrenches to get bias forces/torques
     KDL::TreeIdSolver_RNE solver(full_tree, KDL::Vector(gravity(0), gravity(1), gravity(2)));
     solver.CartToJnt(q, qd, zero, std::map<std::string,KDL::Wrench>(), tau);
@@ -388,6 +382,7 @@ const base::VectorXd &RobotModelKDL::biasForces(){
         uint idx = joint_idx_map_kdl[name];
         bias_forces[i] = tau(idx);
     }
+    bias_forces_valid = true;
     return bias_forces;
 }
 
@@ -398,6 +393,9 @@ const base::MatrixXd& RobotModelKDL::jointSpaceInertiaMatrix(){
         throw std::runtime_error(" Invalid call to jacobianDot()");
     }
 
+    if(joint_space_inertia_mat_valid)
+        return joint_space_inertia_mat;
+
     joint_space_inertia_mat.setZero();
 
     // Use ID solver with zero bias and external wrenches to compute joint space inertia matrix column by column.
@@ -415,6 +413,7 @@ const base::MatrixXd& RobotModelKDL::jointSpaceInertiaMatrix(){
             joint_space_inertia_mat(j, i) = tau(joint_idx_map_kdl[_name]);
         }
     }
+    joint_space_inertia_mat_valid = true;
     return joint_space_inertia_mat;
 }
 
@@ -473,6 +472,9 @@ const base::samples::RigidBodyStateSE3& RobotModelKDL::centerOfMass(){
         throw std::runtime_error(" Invalid call to centerOfMass()");
     }
 
+    if(com_valid)
+        return com_rbs;
+
     double mass = 0.0; // to get the total mass
     KDL::Frame frame = KDL::Frame::Identity(); // Transformation of the last frame
 
@@ -486,6 +488,7 @@ const base::samples::RigidBodyStateSE3& RobotModelKDL::centerOfMass(){
     com_rbs.pose.position = base::Vector3d( cog_pos.x(), cog_pos.y(), cog_pos.z() ) / mass;
     com_rbs.pose.orientation.setIdentity();
     com_rbs.time = joint_state.time;
+    com_valid = true;
     return com_rbs;
 }
 
@@ -31,6 +31,7 @@ protected:
 
     KDL::Tree full_tree;                          /** Overall kinematic tree*/
     std::map<std::string,int> joint_idx_map_kdl;
+    std::vector<int> actuated_joint_idx_kdl;      /** Index of each actuated joint in the KDL joint arrays*/
     KinematicChainKDLMap kdl_chain_map;           /** Map of KDL Chains*/
 
     /**
@@ -100,6 +101,7 @@ public:
      */
     virtual void update(const base::samples::Joints& joint_state,
                         const base::samples::RigidBodyStateSE3& floating_base_state = base::samples::RigidBodyStateSE3());
+    using RobotModel::update;
 
     /** Return entire system state*/
     virtual void systemState(base::VectorXd &q, base::VectorXd &qd, base::VectorXd &qdd);
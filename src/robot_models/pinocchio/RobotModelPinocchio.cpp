@@ -8,6 +8,18 @@
 #include <pinocchio/algorithm/rnea.hpp>
 #include <pinocchio/algorithm/center-of-mass.hpp>
 #include <pinocchio/algorithm/joint-configuration.hpp>
+#include <pinocchio/serialization/model.hpp>
+#include <pinocchio/utils/version.hpp>
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
+#include <boost/serialization/vector.hpp>
+#include <boost/serialization/string.hpp>
+#include <boost/filesystem.hpp>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <cstdio>
+#include <unistd.h>
 
 namespace wbc{
 
@@ -24,6 +36,9 @@ void RobotModelPinocchio::clear(){
 
     RobotModel::clear();
     data.reset();
+    data_bias.reset();
+    chain_frame_ids.clear();
+    link_names.clear();
     model = pinocchio::Model();
 }
 
@@ -31,39 +46,25 @@ bool RobotModelPinocchio::configure(const RobotModelConfig& cfg){
 
     clear();
 
-    // 1. Load Robot Model
+    // 1. Load Robot Model, either from the model cache or from URDF
 
     robot_model_config = cfg;
-    robot_urdf = loadRobotURDF(cfg.file_or_string);
-    if(!robot_urdf){
-        LOG_ERROR("Unable to parse urdf model");
-        return false;
-    }
-    base_frame =  robot_urdf->getRoot()->name;
-    URDFTools::applyJointBlacklist(robot_urdf, cfg.joint_blacklist);
+    has_floating_base = cfg.floating_base;
 
-    try{
-        if(cfg.floating_base){
-            pinocchio::urdf::buildModel(robot_urdf,pinocchio::JointModelFreeFlyer(), model);
-        }
-        else{
-            pinocchio::urdf::buildModel(robot_urdf, model);
-        }
-    }
-    catch(std::invalid_argument e){
-        LOG_ERROR_S << "RobotModelPinocchio: Failed to load urdf model"<<std::endl;
-        return false;
-    }
-    data = std::make_shared<pinocchio::Data>(model);
+    std::string cache_file;
+    if(!cfg.model_cache_dir.empty())
+        cache_file = cfg.model_cache_dir + "/pinocchio_" + modelCacheKey(cfg) + ".bin";
 
-    // Add floating base
-    has_floating_base = cfg.floating_base;
-    world_frame = base_frame;
-    if(has_floating_base){
-        joint_names_floating_base = URDFTools::addFloatingBaseToURDF(robot_urdf);
-        world_frame = robot_urdf->getRoot()->name;
+    if(cache_file.empty() || !loadModelCache(cache_file)){
+        if(!loadModelFromURDF(cfg))
+            return false;
+        if(!cache_file.empty())
+            saveModelCache(cache_file);
     }
 
+    data = std::make_shared<pinocchio::Data>(model);
+    data_bias = std::make_shared<pinocchio::Data>(model);
+
     joint_names = model.names;
     joint_names.erase(joint_names.begin()); // Erase global joint 'universe' which is added by Pinocchio
     if(has_floating_base)
@@ -71,6 +72,14 @@ bool RobotModelPinocchio::configure(const RobotModelConfig& cfg){
     actuated_joint_names = joint_names;
     joint_names = independent_joint_names = joint_names_floating_base + joint_names;
 
+    joint_idx_q.resize(actuated_joint_names.size());
+    joint_idx_v.resize(actuated_joint_names.size());
+    for(size_t i = 0; i < actuated_joint_names.size(); i++){
+        pinocchio::JointIndex joint_id = model.getJointId(actuated_joint_names[i]);
+        joint_idx_q[i] = model.idx_qs[joint_id];
+        joint_idx_v[i] = model.idx_vs[joint_id];
+    }
+
     // 2. Verify consistency of URDF and config
 
     // All contact point have to be a valid link in the robot URDF
@@ -97,12 +106,11 @@ bool RobotModelPinocchio::configure(const RobotModelConfig& cfg){
     q.resize(model.nq);
     qd.resize(model.nv);
     qdd.resize(model.nv);
+    zero_acc.setZero(model.nv);
 
     joint_state.resize(joint_names.size());
     joint_state.names = joint_names;
 
-    URDFTools::jointLimitsFromURDF(robot_urdf, joint_limits);
-
     selection_matrix.resize(noOfActuatedJoints(),noOfJoints());
     selection_matrix.setZero();
     for(uint i = 0; i < actuated_joint_names.size(); i++)
@@ -112,7 +120,7 @@ bool RobotModelPinocchio::configure(const RobotModelConfig& cfg){
     active_contacts = cfg.contact_points;
 
     LOG_DEBUG("------------------- WBC RobotModelPinocchio -----------------");
-    LOG_DEBUG_S << "Robot Name " << robot_urdf->getName() << std::endl;
+    LOG_DEBUG_S << "Robot Name " << model.name << std::endl;
     LOG_DEBUG_S << "Floating base robot: " << has_floating_base << std::endl;
     LOG_DEBUG("Joint Names");
     for(auto n : jointNames())
@@ -131,21 +139,161 @@ bool RobotModelPinocchio::configure(const RobotModelConfig& cfg){
     return true;
 }
 
-void RobotModelPinocchio::update(const base::samples::Joints& joint_state_in,
-                                 const base::samples::RigidBodyStateSE3& floating_base_state_in){
-    if(joint_state_in.elements.size() != joint_state_in.names.size()){
-        LOG_ERROR_S << "Size of names and size of elements in joint state do not match"<<std::endl;
-        throw std::runtime_error("Invalid joint state");
+bool RobotModelPinocchio::loadModelFromURDF(const RobotModelConfig& cfg){
+
+    robot_urdf = loadRobotURDF(cfg.file_or_string);
+    if(!robot_urdf){
+        LOG_ERROR("Unable to parse urdf model");
+        return false;
+    }
+    base_frame =  robot_urdf->getRoot()->name;
+    URDFTools::applyJointBlacklist(robot_urdf, cfg.joint_blacklist);
+
+    try{
+        if(cfg.floating_base){
+            pinocchio::urdf::buildModel(robot_urdf,pinocchio::JointModelFreeFlyer(), model);
+        }
+        else{
+            pinocchio::urdf::buildModel(robot_urdf, model);
+        }
+    }
+    catch(std::invalid_argument e){
+        LOG_ERROR_S << "RobotModelPinocchio: Failed to load urdf model"<<std::endl;
+        return false;
+    }
+
+    // Add floating base
+    world_frame = base_frame;
+    if(cfg.floating_base){
+        joint_names_floating_base = URDFTools::addFloatingBaseToURDF(robot_urdf);
+        world_frame = robot_urdf->getRoot()->name;
+    }
+
+    URDFTools::jointLimitsFromURDF(robot_urdf, joint_limits);
+
+    link_names.clear();
+    for(const auto &l : robot_urdf->links_)
+        link_names.push_back(l.second->name);
+
+    return true;
+}
+
+std::string RobotModelPinocchio::modelCacheKey(const RobotModelConfig& cfg){
+
+    // FNV-1a hash of all inputs that influence the built model. For files, the file content is hashed, so that the cache is invalidated if the file changes
+    uint64_t hash = 14695981039346656037ULL;
+    auto hash_string = [&hash](const std::string& str){
+        for(unsigned char c : str){
+            hash ^= c;
+            hash *= 1099511628211ULL;
+        }
+        hash ^= 0xff; // Separator
+        hash *= 1099511628211ULL;
+    };
+    auto file_or_string = [](const std::string& str){
+        std::ifstream fs(str.c_str());
+        if(!fs)
+            return str;
+        std::stringstream ss;
+        ss << fs.rdbuf();
+        return ss.str();
+    };
+
+    hash_string(std::to_string(model_cache_version));
+    hash_string(pinocchio::printVersion());
+    hash_string(file_or_string(cfg.file_or_string));
+    hash_string(cfg.submechanism_file.empty() ? "" : file_or_string(cfg.submechanism_file));
+    for(const auto &j : cfg.joint_blacklist)
+        hash_string(j);
+    hash_string(cfg.floating_base ? "1" : "0");
+
+    std::stringstream ss;
+    ss << std::hex << std::setw(16) << std::setfill('0') << hash;
+    return ss.str();
+}
+
+bool RobotModelPinocchio::loadModelCache(const std::string& filename){
+
+    std::ifstream fs(filename.c_str(), std::ios::binary);
+    if(!fs)
+        return false;
+
+    try{
+        boost::archive::binary_iarchive ia(fs);
+        std::vector<std::string> limit_names;
+        std::vector<double> limit_values;
+        ia >> model >> base_frame >> world_frame >> joint_names_floating_base >> link_names >> limit_names >> limit_values;
+
+        if(limit_values.size() != limit_names.size()*10)
+            throw std::runtime_error("Inconsistent joint limits");
+        joint_limits.clear();
+        for(size_t i = 0; i < limit_names.size(); i++){
+            const double* v = &limit_values[i*10];
+            base::JointLimitRange range;
+            range.min.position = v[0]; range.min.speed = v[1]; range.min.effort = v[2]; range.min.raw = v[3]; range.min.acceleration = v[4];
+            range.max.position = v[5]; range.max.speed = v[6]; range.max.effort = v[7]; range.max.raw = v[8]; range.max.acceleration = v[9];
+            joint_limits.names.push_back(limit_names[i]);
+            joint_limits.elements.push_back(range);
+        }
+    }
+    catch(std::exception& e){
+        LOG_WARN_S << "RobotModelPinocchio: Failed to load model cache " << filename << ": " << e.what() << ". Loading model from URDF instead" << std::endl;
+        model = pinocchio::Model();
+        base_frame = world_frame = "";
+        joint_names_floating_base.clear();
+        link_names.clear();
+        joint_limits.clear();
+        return false;
     }
 
-    if(joint_state_in.time.isNull()){
-        LOG_ERROR_S << "Joint State does not have a valid timestamp. Or do we have 1970?"<<std::endl;
-        throw std::runtime_error("Invalid joint state");
+    LOG_INFO_S << "RobotModelPinocchio: Loaded robot model from cache " << filename << std::endl;
+    return true;
+}
+
+void RobotModelPinocchio::saveModelCache(const std::string& filename){
+
+    std::vector<std::string> limit_names = joint_limits.names;
+    std::vector<double> limit_values;
+    for(const base::JointLimitRange& range : joint_limits.elements){
+        for(const base::JointState& state : {range.min, range.max}){
+            limit_values.push_back(state.position);
+            limit_values.push_back(state.speed);
+            limit_values.push_back(state.effort);
+            limit_values.push_back(state.raw);
+            limit_values.push_back(state.acceleration);
+        }
+    }
+
+    // Write to a temporary file first and rename it afterwards, so that concurrently starting processes never read a partially written cache
+    try{
+        boost::filesystem::create_directories(robot_model_config.model_cache_dir);
+        std::string tmp_filename = filename + ".tmp" + std::to_string(getpid());
+        {
+            std::ofstream fs(tmp_filename.c_str(), std::ios::binary);
+            if(!fs)
+                throw std::runtime_error("Unable to open file " + tmp_filename);
+            boost::archive::binary_oarchive oa(fs);
+            oa << model << base_frame << world_frame << joint_names_floating_base << link_names << limit_names << limit_values;
+        }
+        if(std::rename(tmp_filename.c_str(), filename.c_str()) != 0){
+            std::remove(tmp_filename.c_str());
+            throw std::runtime_error("Unable to rename " + tmp_filename + " to " + filename);
+        }
+    }
+    catch(std::exception& e){
+        LOG_WARN_S << "RobotModelPinocchio: Failed to write model cache " << filename << ": " << e.what() << std::endl;
     }
+}
 
-    for(auto n : actuated_joint_names)
-        joint_state[n] = joint_state_in[n];
-    joint_state.time = joint_state_in.time;
+bool RobotModelPinocchio::hasLink(const std::string &link_name){
+    return std::find(link_names.begin(), link_names.end(), link_name) != link_names.end();
+}
+
+void RobotModelPinocchio::update(const base::samples::Joints& joint_state_in,
+                                 const base::samples::RigidBodyStateSE3& floating_base_state_in){
+
+    invalidateCache();
+    updateJointState(joint_state_in);
 
     if(has_floating_base){
         if(!floating_base_state_in.hasValidPose() ||
@@ -170,49 +318,42 @@ void RobotModelPinocchio::update(const base::samples::Joints& joint_state_in,
         base::Acceleration fb_acc = floating_base_state.acceleration;
         fb_acc.linear = fb_rot.transpose() * floating_base_state.acceleration.linear;
 
+        // The floating base joints are the first 6 entries in joint_state
         base::Vector3d euler = floating_base_state.pose.orientation.toRotationMatrix().eulerAngles(0, 1, 2);
         for(int i = 0; i < 3; i++){
-            q[i]     = joint_state[joint_names_floating_base[i]].position       = floating_base_state.pose.position[i];
-            joint_state[joint_names_floating_base[i+3]].position = euler(i);
-            qd[i]    = joint_state[joint_names_floating_base[i]].speed          = fb_twist.linear[i];
-            qd[i+3]  = joint_state[joint_names_floating_base[i+3]].speed        = fb_twist.angular[i];
-            qdd[i]   = joint_state[joint_names_floating_base[i]].acceleration   = fb_acc.linear[i];
-            qdd[i+3] = joint_state[joint_names_floating_base[i+3]].acceleration = fb_acc.angular[i];
+            q[i]     = joint_state.elements[i].position       = floating_base_state.pose.position[i];
+            joint_state.elements[i+3].position = euler(i);
+            qd[i]    = joint_state.elements[i].speed          = fb_twist.linear[i];
+            qd[i+3]  = joint_state.elements[i+3].speed        = fb_twist.angular[i];
+            qdd[i]   = joint_state.elements[i].acceleration   = fb_acc.linear[i];
+            qdd[i+3] = joint_state.elements[i+3].acceleration = fb_acc.angular[i];
         }
         q[3] = floating_base_state.pose.orientation.x();
         q[4] = floating_base_state.pose.orientation.y();
         q[5] = floating_base_state.pose.orientation.z();
         q[6] = floating_base_state.pose.orientation.w();
 
-        // Subtract 2 due to universe & root_joint
-        for(auto name : actuated_joint_names){
-            if(!hasJoint(name)){
-                LOG_ERROR_S << "Joint " << name << " is a non-fixed joint in the robot model, but it is not in the joint state vector."
-                            << "You should either set the joint to 'fixed' in your URDF file or provide a valid joint state for it" << std::endl;
-                throw std::runtime_error("Incomplete Joint State");
-            }
-            base::JointState state = joint_state[name];
-            q[model.getJointId(name)-2+7]   = state.position;     // first 7 elements in q are floating base pose
-            qd[model.getJointId(name)-2+6]  = state.speed;        // first 6 elements in q are floating base twist
-            qdd[model.getJointId(name)-2+6] = state.acceleration; // first 6 elements in q are floating base acceleration
-        }
         if(floating_base_state.time > joint_state.time)
             joint_state.time = floating_base_state.time;
     }
-    else{
-        for(auto name : actuated_joint_names){
-            if(!hasJoint(name)){
-                LOG_ERROR_S << "Joint " << name << " is a non-fixed joint in the robot model, but it is not in the joint state vector."
-                            << "You should either set the joint to 'fixed' in your URDF file or provide a valid joint state for it" << std::endl;
-                throw std::runtime_error("Incomplete Joint State");
-            }
-            base::JointState state = joint_state[name];
-            q[model.getJointId(name)-1]   = state.position;
-            qd[model.getJointId(name)-1]  = state.speed;
-            qdd[model.getJointId(name)-1] = state.acceleration;
-        }
+
+    // Indices of the actuated joints in q, qd and qdd have been computed in configure()
+    for(size_t i = 0; i < actuated_joint_indices.size(); i++){
+        const base::JointState &state = joint_state.elements[actuated_joint_indices[i]];
+        q[joint_idx_q[i]]   = state.position;
+        qd[joint_idx_v[i]]  = state.speed;
+        qdd[joint_idx_v[i]] = state.acceleration;
     }
 
+    // Compute all kinematic quantities once, so that they can be reused by the subsequent queries. computeJointJacobiansTimeVariation()
+    // computes placements, velocities, joint Jacobians and their time derivatives in a single pass, forwardKinematics() adds the accelerations
+    pinocchio::computeJointJacobiansTimeVariation(model,*data,q,qd);
+    pinocchio::forwardKinematics(model,*data,q,qd,qdd);
+    pinocchio::updateFramePlacements(model,*data);
+
+    // The spatial acceleration bias requires the spatial acceleration for qdd = 0
+    pinocchio::forwardKinematics(model,*data_bias,q,qd,zero_acc);
+    pinocchio::updateFramePlacements(model,*data_bias);
 }
 
 void RobotModelPinocchio::systemState(base::VectorXd &_q, base::VectorXd &_qd, base::VectorXd &_qdd){
@@ -221,101 +362,154 @@ void RobotModelPinocchio::systemState(base::VectorXd &_q, base::VectorXd &_qd, b
     _qdd = qdd;
 }
 
-const base::samples::RigidBodyStateSE3 &RobotModelPinocchio::rigidBodyState(const std::string &root_frame, const std::string &tip_frame){
-    if(joint_state.time.isNull()){
-        LOG_ERROR("RobotModelPinocchio: You have to call update() with appropriately timestamped joint data at least once before requesting kinematic information!");
-        throw std::runtime_error(" Invalid call to rigidBodyState()");
-    }
-    if(root_frame != world_frame){
-        LOG_ERROR_S<<"Requested Forward kinematics computation for kinematic chain "<<root_frame<<"->"<<tip_frame<<" but the pinocchio robot model always requires the root frame to be the root of the full model"<<std::endl;
+uint RobotModelPinocchio::chainFrameId(uint chain_handle){
+
+    if(chain_handle < chain_frame_ids.size() && chain_frame_ids[chain_handle] >= 0)
+        return chain_frame_ids[chain_handle];
+
+    const std::pair<std::string,std::string>& c = chain(chain_handle);
+    if(c.first != world_frame){
+        LOG_ERROR_S<<"Requested kinematic information for chain "<<c.first<<"->"<<c.second<<" but the pinocchio robot model always requires the root frame to be the root of the full model"<<std::endl;
         throw std::runtime_error("Invalid root frame");
     }
 
-    std::string use_tip_frame = tip_frame;
+    std::string use_tip_frame = c.second;
     if(use_tip_frame == "world")
         use_tip_frame = "universe";
 
     uint idx = model.getFrameId(use_tip_frame);
     if(idx == model.frames.size()){
-        LOG_ERROR_S<<"Requested Forward kinematics for tip frame "<<use_tip_frame<<" but this frame does not exist in Pinocchio"<<std::endl;
+        LOG_ERROR_S<<"Requested kinematic information for tip frame "<<use_tip_frame<<" but this frame does not exist in Pinocchio"<<std::endl;
         throw std::runtime_error("Invalid tip frame");
     }
 
-    pinocchio::forwardKinematics(model,*data,q,qd,qdd);
-    pinocchio::updateFramePlacement(model,*data,idx);
+    if(chain_frame_ids.size() < chains.size())
+        chain_frame_ids.resize(chains.size(), -1);
+    chain_frame_ids[chain_handle] = idx;
+
+    // Pinocchio only writes the columns of the joints that support the given frame, so the remaining columns have to be zeroed once
+    ChainCache& cache = chainCache(chain_handle);
+    cache.space_jac.setZero(6,model.nv);
+    cache.body_jac.setZero(6,model.nv);
+    cache.jac_dot.setZero(6,model.nv);
+    cache.space_jac_valid = cache.body_jac_valid = cache.acc_bias_valid = cache.jac_dot_valid = false;
+    return idx;
+}
+
+const base::samples::RigidBodyStateSE3 &RobotModelPinocchio::rigidBodyState(const std::string &root_frame, const std::string &tip_frame){
+    return rigidBodyState(registerChain(root_frame, tip_frame));
+}
+
+const base::samples::RigidBodyStateSE3 &RobotModelPinocchio::rigidBodyState(uint chain_handle){
+    if(joint_state.time.isNull()){
+        LOG_ERROR("RobotModelPinocchio: You have to call update() with appropriately timestamped joint data at least once before requesting kinematic information!");
+        throw std::runtime_error(" Invalid call to rigidBodyState()");
+    }
+
+    uint idx = chainFrameId(chain_handle);
 
     rbs.time = joint_state.time;
-    rbs.frame_id = root_frame;
+    rbs.frame_id = world_frame;
     rbs.pose.position = data->oMf[idx].translation();
     rbs.pose.orientation = base::Quaterniond(data->oMf[idx].rotation());
     // The LOCAL_WORLD_ALIGNED frame convention corresponds to the frame centered on the moving part (Joint, Frame, etc.)
     // but with axes aligned with the frame of the Universe. This a MIXED representation betwenn the LOCAL and the WORLD conventions.
-    rbs.twist.linear = pinocchio::getFrameVelocity(model, *data, idx, pinocchio::LOCAL_WORLD_ALIGNED).linear();
-    rbs.twist.angular = pinocchio::getFrameVelocity(model, *data, idx, pinocchio::LOCAL_WORLD_ALIGNED).angular();
-    rbs.acceleration.linear = pinocchio::getFrameClassicalAcceleration(model, *data, idx, pinocchio::LOCAL_WORLD_ALIGNED).linear();
-    rbs.acceleration.angular = pinocchio::getFrameClassicalAcceleration(model, *data, idx, pinocchio::LOCAL_WORLD_ALIGNED).angular();
+    pinocchio::Motion twist = pinocchio::getFrameVelocity(model, *data, idx, pinocchio::LOCAL_WORLD_ALIGNED);
+    pinocchio::Motion acc = pinocchio::getFrameClassicalAcceleration(model, *data, idx, pinocchio::LOCAL_WORLD_ALIGNED);
+    rbs.twist.linear = twist.linear();
+    rbs.twist.angular = twist.angular();
+    rbs.acceleration.linear = acc.linear();
+    rbs.acceleration.angular = acc.angular();
 
     return rbs;
 }
 
 const base::MatrixXd &RobotModelPinocchio::spaceJacobian(const std::string &root_frame, const std::string &tip_frame){
+    return spaceJacobian(registerChain(root_frame, tip_frame));
+}
+
+const base::MatrixXd &RobotModelPinocchio::spaceJacobian(uint chain_handle){
 
     if(joint_state.time.isNull()){
         LOG_ERROR("RobotModelPinocchio: You have to call update() with appropriately timestamped joint data at least once before requesting kinematic information!");
-        throw std::runtime_error(" Invalid call to rigidBodyState()");
+        throw std::runtime_error(" Invalid call to spaceJacobian()");
     }
 
-    if(root_frame != world_frame){
-        LOG_ERROR_S<<"Requested space Jacobian computation for kinematic chain "<<root_frame<<"->"<<tip_frame<<" but the pinocchio robot model always requires the root frame to be the root of the full model"<<std::endl;
-        throw std::runtime_error("Invalid root frame");
+    uint idx = chainFrameId(chain_handle);
+    ChainCache& cache = chain_cache[chain_handle];
+    if(!cache.space_jac_valid){
+        pinocchio::getFrameJacobian(model, *data, idx, pinocchio::LOCAL_WORLD_ALIGNED, cache.space_jac);
+        cache.space_jac_valid = true;
     }
+    return cache.space_jac;
+}
 
-    std::string use_tip_frame = tip_frame;
-    if(use_tip_frame == "world")
-        use_tip_frame = "universe";
+const base::MatrixXd &RobotModelPinocchio::bodyJacobian(const std::string &root_frame, const std::string &tip_frame){
+    return bodyJacobian(registerChain(root_frame, tip_frame));
+}
 
-    uint idx = model.getFrameId(use_tip_frame);
-    if(idx == model.frames.size()){
-        LOG_ERROR_S<<"Requested Forward kinematics for tip frame "<<use_tip_frame<<" but this frame does not exist in Pinocchio"<<std::endl;
-        throw std::runtime_error("Invalid tip frame");
-    }
+const base::MatrixXd &RobotModelPinocchio::bodyJacobian(uint chain_handle){
 
-    std::string chain_id = chainID(root_frame, tip_frame);
-    space_jac_map[chain_id].resize(6,model.nv);
-    space_jac_map[chain_id].setZero();
-    pinocchio::computeFrameJacobian(model, *data, q, idx, pinocchio::LOCAL_WORLD_ALIGNED, space_jac_map[chain_id]);
+    if(joint_state.time.isNull()){
+        LOG_ERROR("RobotModelPinocchio: You have to call update() with appropriately timestamped joint data at least once before requesting kinematic information!");
+        throw std::runtime_error(" Invalid call to bodyJacobian()");
+    }
 
-    return space_jac_map[chain_id];
+    uint idx = chainFrameId(chain_handle);
+    ChainCache& cache = chain_cache[chain_handle];
+    if(!cache.body_jac_valid){
+        pinocchio::getFrameJacobian(model, *data, idx, pinocchio::LOCAL, cache.body_jac);
+        cache.body_jac_valid = true;
+    }
+    return cache.body_jac;
 }
 
-const base::MatrixXd &RobotModelPinocchio::bodyJacobian(const std::string &root_frame, const std::string &tip_frame){
+void RobotModelPinocchio::spaceJacobians(const std::vector<uint> &chain_handles, Eigen::Ref<base::MatrixXd> jacobians){
 
     if(joint_state.time.isNull()){
         LOG_ERROR("RobotModelPinocchio: You have to call update() with appropriately timestamped joint data at least once before requesting kinematic information!");
-        throw std::runtime_error(" Invalid call to rigidBodyState()");
+        throw std::runtime_error(" Invalid call to spaceJacobians()");
     }
-
-    if(root_frame != world_frame){
-        LOG_ERROR_S<<"Requested space Jacobian computation for kinematic chain "<<root_frame<<"->"<<tip_frame<<" but the pinocchio robot model always requires the root frame to be the root of the full model"<<std::endl;
-        throw std::runtime_error("Invalid root frame");
+    if(jacobians.rows() != 6*chain_handles.size() || jacobians.cols() != model.nv){
+        LOG_ERROR_S << "Output buffer has size " << jacobians.rows() << "x" << jacobians.cols() << " but should have size " << 6*chain_handles.size() << "x" << model.nv << std::endl;
+        throw std::invalid_argument("Invalid buffer size in spaceJacobians()");
     }
 
-    std::string use_tip_frame = tip_frame;
-    if(use_tip_frame == "world")
-        use_tip_frame = "universe";
+    // Pinocchio only writes the columns of the joints that support the given frame, so the remaining columns have to be zeroed
+    jacobians.setZero();
+    for(uint i = 0; i < chain_handles.size(); i++)
+        pinocchio::getFrameJacobian(model, *data, chainFrameId(chain_handles[i]), pinocchio::LOCAL_WORLD_ALIGNED, jacobians.middleRows<6>(6*i));
+}
 
-    uint idx = model.getFrameId(use_tip_frame);
-    if(idx == model.frames.size()){
-        LOG_ERROR_S<<"Requested Forward kinematics for tip frame "<<use_tip_frame<<" but this frame does not exist in Pinocchio"<<std::endl;
-        throw std::runtime_error("Invalid tip frame");
+void RobotModelPinocchio::bodyJacobians(const std::vector<uint> &chain_handles, Eigen::Ref<base::MatrixXd> jacobians){
+
+    if(joint_state.time.isNull()){
+        LOG_ERROR("RobotModelPinocchio: You have to call update() with appropriately timestamped joint data at least once before requesting kinematic information!");
+        throw std::runtime_error(" Invalid call to bodyJacobians()");
+    }
+    if(jacobians.rows() != 6*chain_handles.size() || jacobians.cols() != model.nv){
+        LOG_ERROR_S << "Output buffer has size " << jacobians.rows() << "x" << jacobians.cols() << " but should have size " << 6*chain_handles.size() << "x" << model.nv << std::endl;
+        throw std::invalid_argument("Invalid buffer size in bodyJacobians()");
     }
 
-    std::string chain_id = chainID(root_frame, tip_frame);
-    body_jac_map[chain_id].resize(6,model.nv);
-    body_jac_map[chain_id].setZero();
-    pinocchio::computeFrameJacobian(model, *data, q, idx, pinocchio::LOCAL, body_jac_map[chain_id]);
+    jacobians.setZero();
+    for(uint i = 0; i < chain_handles.size(); i++)
+        pinocchio::getFrameJacobian(model, *data, chainFrameId(chain_handles[i]), pinocchio::LOCAL, jacobians.middleRows<6>(6*i));
+}
 
-    return body_jac_map[chain_id];
+std::vector<uint> RobotModelPinocchio::chainJointIndices(uint chain_handle){
+
+    // The root frame of a chain is always the root of the model, so the relevant joints are all joints that support the tip frame. The
+    // supporting joints of a joint are ordered from the root to the joint, so the indices are already in ascending order
+    const pinocchio::JointIndex joint_id = model.frames[chainFrameId(chain_handle)].parent;
+    std::vector<uint> indices;
+    for(pinocchio::JointIndex j : model.supports[joint_id]){
+        if(j == 0) // Universe
+            continue;
+        for(int k = 0; k < model.nvs[j]; k++)
+            indices.push_back(model.idx_vs[j] + k);
+    }
+    return indices;
 }
 
 const base::MatrixXd &RobotModelPinocchio::comJacobian(){
@@ -325,42 +519,56 @@ const base::MatrixXd &RobotModelPinocchio::comJacobian(){
         throw std::runtime_error("Invalid call to comJacobian()");
     }
 
+    if(com_jac_valid)
+        return com_jac;
+
     pinocchio::jacobianCenterOfMass(model, *data, q);
-    com_jac.resize(3,noOfJoints());
     com_jac = data->Jcom;
+    com_jac_valid = true;
     return com_jac;
 }
 
 const base::Acceleration &RobotModelPinocchio::spatialAccelerationBias(const std::string &root_frame, const std::string &tip_frame){
+    return spatialAccelerationBias(registerChain(root_frame, tip_frame));
+}
+
+const base::Acceleration &RobotModelPinocchio::spatialAccelerationBias(uint chain_handle){
 
     if(joint_state.time.isNull()){
         LOG_ERROR("RobotModelPinocchio: You have to call update() with appropriately timestamped joint data at least once before requesting kinematic information!");
-        throw std::runtime_error(" Invalid call to rigidBodyState()");
-    }
-
-    if(root_frame != world_frame){
-        LOG_ERROR_S<<"Requested space Jacobian computation for kinematic chain "<<root_frame<<"->"<<tip_frame<<" but the pinocchio robot model always requires the root frame to be the root of the full model"<<std::endl;
-        throw std::runtime_error("Invalid root frame");
+        throw std::runtime_error(" Invalid call to spatialAccelerationBias()");
     }
 
-    std::string use_tip_frame = tip_frame;
-    if(use_tip_frame == "world")
-        use_tip_frame = "universe";
-
-    uint idx = model.getFrameId(use_tip_frame);
-    if(idx == model.frames.size()){
-        LOG_ERROR_S<<"Requested Forward kinematics for tip frame "<<use_tip_frame<<" but this frame does not exist in Pinocchio"<<std::endl;
-        throw std::runtime_error("Invalid tip frame");
+    uint idx = chainFrameId(chain_handle);
+    ChainCache& cache = chain_cache[chain_handle];
+    if(!cache.acc_bias_valid){
+        pinocchio::Motion acc = pinocchio::getFrameClassicalAcceleration(model, *data_bias, idx, pinocchio::LOCAL_WORLD_ALIGNED);
+        cache.acc_bias.linear = acc.linear();
+        cache.acc_bias.angular = acc.angular();
+        cache.acc_bias_valid = true;
     }
-    pinocchio::forwardKinematics(model,*data,q,qd,base::VectorXd::Zero(model.nv));
-    spatial_acc_bias.linear = pinocchio::getFrameClassicalAcceleration(model, *data, idx, pinocchio::LOCAL_WORLD_ALIGNED).linear();
-    spatial_acc_bias.angular = pinocchio::getFrameClassicalAcceleration(model, *data, idx, pinocchio::LOCAL_WORLD_ALIGNED).angular();
-    return spatial_acc_bias;
+    return cache.acc_bias;
 }
 
 const base::MatrixXd &RobotModelPinocchio::jacobianDot(const std::string &root_frame, const std::string &tip_frame){
+    return jacobianDot(registerChain(root_frame, tip_frame));
+}
+
+const base::MatrixXd &RobotModelPinocchio::jacobianDot(uint chain_handle){
 
-    throw std::runtime_error("Not implemented: jacobianDot has not been implemented for RobotModelPinocchio");
+    if(joint_state.time.isNull()){
+        LOG_ERROR("RobotModelPinocchio: You have to call update() with appropriately timestamped joint data at least once before requesting kinematic information!");
+        throw std::runtime_error(" Invalid call to jacobianDot()");
+    }
+
+    // Same convention as in RobotModelKDL (hybrid representation): Reference frame is the root frame, reference point is the tip frame
+    uint idx = chainFrameId(chain_handle);
+    ChainCache& cache = chain_cache[chain_handle];
+    if(!cache.jac_dot_valid){
+        pinocchio::getFrameJacobianTimeVariation(model, *data, idx, pinocchio::LOCAL_WORLD_ALIGNED, cache.jac_dot);
+        cache.jac_dot_valid = true;
+    }
+    return cache.jac_dot;
 }
 
 const base::MatrixXd &RobotModelPinocchio::jointSpaceInertiaMatrix(){
@@ -370,10 +578,14 @@ const base::MatrixXd &RobotModelPinocchio::jointSpaceInertiaMatrix(){
         throw std::runtime_error(" Invalid call to jointSpaceInertiaMatrix()");
     }
 
+    if(joint_space_inertia_mat_valid)
+        return joint_space_inertia_mat;
+
     pinocchio::crba(model, *data, q);
     joint_space_inertia_mat = data->M;
     // copy upper right triangular part to lower left triangular part (they are symmetric), as pinocchio only computes the former
     joint_space_inertia_mat.triangularView<Eigen::StrictlyLower>() = joint_space_inertia_mat.transpose().triangularView<Eigen::StrictlyLower>();
+    joint_space_inertia_mat_valid = true;
     return joint_space_inertia_mat;
 }
 
@@ -384,8 +596,12 @@ const base::VectorXd &RobotModelPinocchio::biasForces(){
         throw std::runtime_error(" Invalid call to biasForces()");
     }
 
+    if(bias_forces_valid)
+        return bias_forces;
+
     pinocchio::nonLinearEffects(model, *data, q, qd);
     bias_forces = data->nle;
+    bias_forces_valid = true;
     return bias_forces;
 }
 
@@ -396,6 +612,9 @@ const base::samples::RigidBodyStateSE3& RobotModelPinocchio::centerOfMass(){
         throw std::runtime_error(" Invalid call to centerOfMass()");
     }
 
+    if(com_valid)
+        return com_rbs;
+
     pinocchio::centerOfMass(model, *data, q, qd, qdd);
     com_rbs.pose.position       = data->com[0];
     com_rbs.twist.linear        = data->vcom[0];
@@ -405,6 +624,7 @@ const base::samples::RigidBodyStateSE3& RobotModelPinocchio::centerOfMass(){
     com_rbs.acceleration.angular.setZero();
     com_rbs.time = joint_state.time;
     com_rbs.frame_id = world_frame;
+    com_valid = true;
     return com_rbs;
 }
 
@@ -14,10 +14,34 @@ protected:
     Eigen::VectorXd q, qd, qdd;
     pinocchio::Model model;
     typedef std::shared_ptr<pinocchio::Data> DataPtr;
-    DataPtr data;
+    DataPtr data;      /** Kinematics (placements, velocities, accelerations, joint Jacobians and their time derivatives) for the current q, qd, qdd. Computed once in update()*/
+    DataPtr data_bias; /** Kinematics for the current q, qd and zero qdd. Used for computing the spatial acceleration bias*/
+    Eigen::VectorXd zero_acc;
+    std::vector<int> joint_idx_q, joint_idx_v;     /** Index of each actuated joint in q and in qd/qdd*/
+
+    std::vector<int> chain_frame_ids;              /** Pinocchio frame id of the tip frame for each registered chain, -1 if not resolved yet*/
+    std::vector<std::string> link_names;           /** Names of all links in the robot model*/
+
+    /** Version of the model cache file format. Has to be increased whenever the content of the cache files changes*/
+    static const int model_cache_version = 1;
 
     /** Free all data*/
     void clear();
+
+    /** Return the Pinocchio frame id of the tip frame of the given chain. The frame id is looked up only on the first call for each chain*/
+    uint chainFrameId(uint chain_handle);
+
+    /** Parse the URDF model and build the Pinocchio model from it. Also fills all URDF related data (base/world frame, joint limits, link names)*/
+    bool loadModelFromURDF(const RobotModelConfig& cfg);
+
+    /** Return the key of the model cache for the given configuration, i.e., a hash of the URDF, submechanism file, joint blacklist and floating base flag*/
+    std::string modelCacheKey(const RobotModelConfig& cfg);
+
+    /** Restore the Pinocchio model and all URDF related data from the given cache file. Returns false if the file does not exist or cannot be read*/
+    bool loadModelCache(const std::string& filename);
+
+    /** Write the Pinocchio model and all URDF related data to the given cache file*/
+    void saveModelCache(const std::string& filename);
 public:
     RobotModelPinocchio();
     ~RobotModelPinocchio();
@@ -30,12 +54,14 @@ public:
     virtual bool configure(const RobotModelConfig& cfg);
 
     /**
-     * @brief Update the robot configuration
+     * @brief Update the robot configuration. This will also compute forward kinematics, joint Jacobians and their time derivatives for the entire robot, so that subsequent calls
+     *        to rigidBodyState(), spaceJacobian(), bodyJacobian(), spatialAccelerationBias() and jacobianDot() do not have to recompute them.
      * @param joint_state The joint_state vector. Has to contain all robot joints that are configured in the model.
      * @param poses Optional, only for floating base robots: update the floating base state of the robot model.
      */
     virtual void update(const base::samples::Joints& joint_state,
                         const base::samples::RigidBodyStateSE3& floating_base_state = base::samples::RigidBodyStateSE3());
+    using RobotModel::update;
 
     /** Return entire system state*/
     virtual void systemState(base::VectorXd &q, base::VectorXd &qd, base::VectorXd &qdd);
@@ -43,6 +69,9 @@ public:
     /** Returns the pose, twist and spatial acceleration between the two given frames. All quantities are defined in root_frame coordinates*/
     virtual const base::samples::RigidBodyStateSE3 &rigidBodyState(const std::string &root_frame, const std::string &tip_frame);
 
+    /** Same as rigidBodyState(root_frame, tip_frame), but for a chain handle obtained from registerChain()*/
+    virtual const base::samples::RigidBodyStateSE3 &rigidBodyState(uint chain_handle);
+
     /** @brief Returns the Space Jacobian for the kinematic chain between root and the tip frame as full body Jacobian. Size of the Jacobian will be 6 x nJoints, where nJoints is the number of joints of the whole robot. The order of the
       * columns will be the same as the configured joint order of the robot. The columns that correspond to joints that are not part of the kinematic chain will have only zeros as entries.
       * @param root_frame Root frame of the chain. Has to be a valid link in the robot model.
@@ -51,6 +80,9 @@ public:
       */
     virtual const base::MatrixXd &spaceJacobian(const std::string &root_frame, const std::string &tip_frame);
 
+    /** @brief Same as spaceJacobian(root_frame, tip_frame), but for a chain handle obtained from registerChain()*/
+    virtual const base::MatrixXd &spaceJacobian(uint chain_handle);
+
     /** @brief Returns the Body Jacobian for the kinematic chain between root and the tip frame as full body Jacobian. Size of the Jacobian will be 6 x nJoints, where nJoints is the number of joints of the whole robot. The order of the
       * columns will be the same as the configured joint order of the robot. The columns that correspond to joints that are not part of the kinematic chain will have only zeros as entries.
       * @param root_frame Root frame of the chain. Has to be a valid link in the robot model.
@@ -59,6 +91,18 @@ public:
       */
     virtual const base::MatrixXd &bodyJacobian(const std::string &root_frame, const std::string &tip_frame);
 
+    /** @brief Same as bodyJacobian(root_frame, tip_frame), but for a chain handle obtained from registerChain()*/
+    virtual const base::MatrixXd &bodyJacobian(uint chain_handle);
+
+    /** @brief Compute the Space Jacobians for multiple kinematic chains in one call and write them directly to the given buffer. See RobotModel::spaceJacobians() for details*/
+    virtual void spaceJacobians(const std::vector<uint> &chain_handles, Eigen::Ref<base::MatrixXd> jacobians);
+
+    /** @brief Compute the Body Jacobians for multiple kinematic chains in one call and write them directly to the given buffer. See RobotModel::bodyJacobians() for details*/
+    virtual void bodyJacobians(const std::vector<uint> &chain_handles, Eigen::Ref<base::MatrixXd> jacobians);
+
+    /** @brief Return the indices of all joints that support the tip frame of the given chain, see RobotModel::chainJointIndices() for details*/
+    virtual std::vector<uint> chainJointIndices(uint chain_handle);
+
     /** @brief Returns the CoM Jacobian for the entire robot, which maps the robot joint velocities to linear spatial velocities in robot base coordinates.
       * Size of the Jacobian will be 3 x nJoints, where nJoints is the number of joints of the whole robot. The order of the
       * columns will be the same as the configured joint order of the robot.
@@ -73,8 +117,11 @@ public:
       */
     virtual const base::Acceleration &spatialAccelerationBias(const std::string &root_frame, const std::string &tip_frame);
 
-    /** @brief Returns the derivative of the Jacobian for the kinematic chain between root and the tip frame as full body Jacobian. By convention reference frame & reference point
-      *  of the Jacobian will be the root frame (corresponding to the body Jacobian). Size of the Jacobian will be 6 x nJoints, where nJoints is the number of joints of the whole robot. The order of the
+    /** @brief Same as spatialAccelerationBias(root_frame, tip_frame), but for a chain handle obtained from registerChain()*/
+    virtual const base::Acceleration &spatialAccelerationBias(uint chain_handle);
+
+    /** @brief Returns the derivative of the Jacobian for the kinematic chain between root and the tip frame as full body Jacobian. Same convention as in RobotModelKDL: Reference frame
+      *  of the Jacobian will be the root frame, reference point will be the tip frame (corresponding to the space Jacobian). Size of the Jacobian will be 6 x nJoints, where nJoints is the number of joints of the whole robot. The order of the
       * columns will be the same as the joint order of the robot. The columns that correspond to joints that are not part of the kinematic chain will have only zeros as entries.
       * @param root_frame Root frame of the chain. Has to be a valid link in the robot model.
       * @param tip_frame Tip frame of the chain. Has to be a valid link in the robot model.
@@ -82,6 +129,9 @@ public:
       */
     virtual const base::MatrixXd &jacobianDot(const std::string &root_frame, const std::string &tip_frame);
 
+    /** @brief Same as jacobianDot(root_frame, tip_frame), but for a chain handle obtained from registerChain()*/
+    virtual const base::MatrixXd &jacobianDot(uint chain_handle);
+
     /** @brief Compute and return the joint space mass-inertia matrix, which is nj x nj, where nj is the number of joints of the system*/
     virtual const base::MatrixXd &jointSpaceInertiaMatrix();
 
@@ -94,6 +144,9 @@ public:
     /** @brief Compute and return the inverse dynamics solution*/
     virtual void computeInverseDynamics(base::commands::Joints &solver_output);
 
+    /** @brief Return True if given link name is available in robot model, false otherwise*/
+    virtual bool hasLink(const std::string& link_name);
+
 };
 
 }
@@ -5,6 +5,8 @@
 #include "../../../core/RobotModelConfig.hpp"
 #include "../../../tools/URDFTools.hpp"
 #include "../../test/test_robot_model.hpp"
+#include <boost/filesystem.hpp>
+#include <unistd.h>
 
 using namespace std;
 using namespace wbc;
@@ -146,3 +148,224 @@ BOOST_AUTO_TEST_CASE(dynamics){
     testDynamics(robot_model, false);
 
 }
+
+BOOST_AUTO_TEST_CASE(chain_handles){
+
+    /**
+     * Verify that querying kinematics by chain handle gives the same results as querying by frame names
+     */
+
+    string urdf_file = "../../../../../models/kuka/urdf/kuka_iiwa.urdf";
+    string tip_frame = "kuka_lbr_l_tcp";
+
+    RobotModelPtr robot_model = make_shared<RobotModelPinocchio>();
+    RobotModelConfig cfg(urdf_file);
+    cfg.floating_base = true;
+    BOOST_CHECK(robot_model->configure(cfg));
+
+    uint handle = robot_model->registerChain(robot_model->worldFrame(), tip_frame);
+    BOOST_CHECK(handle == robot_model->registerChain(robot_model->worldFrame(), tip_frame));
+    BOOST_CHECK_THROW(robot_model->spaceJacobian(handle+1), std::invalid_argument);
+
+    base::samples::Joints joint_state = makeRandomJointState(robot_model->actuatedJointNames());
+    BOOST_CHECK_NO_THROW(robot_model->update(joint_state, makeRandomFloatingBaseState()));
+
+    base::MatrixXd space_jac = robot_model->spaceJacobian(robot_model->worldFrame(), tip_frame);
+    base::MatrixXd body_jac = robot_model->bodyJacobian(robot_model->worldFrame(), tip_frame);
+    base::Acceleration bias = robot_model->spatialAccelerationBias(robot_model->worldFrame(), tip_frame);
+    base::samples::RigidBodyStateSE3 rbs = robot_model->rigidBodyState(robot_model->worldFrame(), tip_frame);
+
+    BOOST_CHECK(space_jac.isApprox(robot_model->spaceJacobian(handle)));
+    BOOST_CHECK(body_jac.isApprox(robot_model->bodyJacobian(handle)));
+    BOOST_CHECK(bias.linear.isApprox(robot_model->spatialAccelerationBias(handle).linear));
+    BOOST_CHECK(bias.angular.isApprox(robot_model->spatialAccelerationBias(handle).angular));
+    BOOST_CHECK(rbs.pose.position.isApprox(robot_model->rigidBodyState(handle).pose.position));
+    BOOST_CHECK(rbs.twist.linear.isApprox(robot_model->rigidBodyState(handle).twist.linear));
+}
+
+BOOST_AUTO_TEST_CASE(batched_queries){
+
+    /**
+     * Verify that the batched multi-frame queries give the same results as the single frame queries
+     */
+
+    string urdf_file = "../../../../../models/kuka/urdf/kuka_iiwa.urdf";
+    vector<string> tip_frames = {"kuka_lbr_l_tcp", "kuka_lbr_l_link_4"};
+
+    RobotModelPtr robot_model = make_shared<RobotModelPinocchio>();
+    RobotModelConfig cfg(urdf_file);
+    cfg.floating_base = true;
+    BOOST_CHECK(robot_model->configure(cfg));
+
+    vector<uint> handles;
+    for(auto t : tip_frames)
+        handles.push_back(robot_model->registerChain(robot_model->worldFrame(), t));
+
+    base::samples::Joints joint_state = makeRandomJointState(robot_model->actuatedJointNames());
+    BOOST_CHECK_NO_THROW(robot_model->update(joint_state, makeRandomFloatingBaseState()));
+
+    uint nj = robot_model->noOfJoints();
+    base::MatrixXd space_jacs(6*handles.size(), nj), body_jacs(6*handles.size(), nj);
+    base::VectorXd biases(6*handles.size());
+    robot_model->spaceJacobians(handles, space_jacs);
+    robot_model->bodyJacobians(handles, body_jacs);
+    robot_model->spatialAccelerationBiases(handles, biases);
+
+    for(uint i = 0; i < handles.size(); i++){
+        BOOST_CHECK(space_jacs.middleRows(6*i,6).isApprox(robot_model->spaceJacobian(handles[i])));
+        BOOST_CHECK(body_jacs.middleRows(6*i,6).isApprox(robot_model->bodyJacobian(handles[i])));
+        BOOST_CHECK(biases.segment(6*i,3).isApprox(robot_model->spatialAccelerationBias(handles[i]).linear));
+        BOOST_CHECK(biases.segment(6*i+3,3).isApprox(robot_model->spatialAccelerationBias(handles[i]).angular));
+    }
+
+    base::MatrixXd wrong_size(6, nj);
+    BOOST_CHECK_THROW(robot_model->spaceJacobians(handles, wrong_size), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(chain_joint_indices){
+
+    /**
+     * Verify that all Jacobian columns of a kinematic chain that do not belong to the chain joint indices are zero and that the URDF-based
+     * default implementation gives the same result
+     */
+
+    string urdf_file = "../../../../../models/rh5/urdf/rh5_legs.urdf";
+    string tip_frame = "FL_SupportCenter";
+
+    RobotModelPtr robot_model = make_shared<RobotModelPinocchio>();
+    RobotModelConfig cfg(urdf_file);
+    cfg.floating_base = true;
+    cfg.contact_points.names = {"FL_SupportCenter", "FR_SupportCenter"};
+    cfg.contact_points.elements = {ActiveContact(1,0.6), ActiveContact(1,0.6)};
+    BOOST_CHECK(robot_model->configure(cfg));
+
+    base::samples::Joints joint_state = makeRandomJointState(robot_model->actuatedJointNames());
+    BOOST_CHECK_NO_THROW(robot_model->update(joint_state, makeRandomFloatingBaseState()));
+
+    uint handle = robot_model->registerChain(robot_model->worldFrame(), tip_frame);
+    vector<uint> indices = robot_model->chainJointIndices(handle);
+    BOOST_CHECK_EQUAL(indices.size(), 12); // Floating base + one leg
+    BOOST_CHECK(indices == robot_model->RobotModel::chainJointIndices(handle));
+
+    const base::MatrixXd& jac = robot_model->spaceJacobian(handle);
+    for(uint i = 0; i < robot_model->noOfJoints(); i++){
+        if(find(indices.begin(), indices.end(), i) == indices.end())
+            BOOST_CHECK(jac.col(i).isZero());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(joint_state_layout){
+
+    /**
+     * Verify that updating the robot model from raw joint vectors in a bound (permuted) joint layout gives the same result as updating from a named joint state
+     */
+
+    string urdf_file = "../../../../../models/kuka/urdf/kuka_iiwa.urdf";
+    string tip_frame = "kuka_lbr_l_tcp";
+
+    RobotModelPtr robot_model = make_shared<RobotModelPinocchio>();
+    RobotModelConfig cfg(urdf_file);
+    BOOST_CHECK(robot_model->configure(cfg));
+
+    base::samples::Joints joint_state = makeRandomJointState(robot_model->actuatedJointNames());
+    BOOST_CHECK_NO_THROW(robot_model->update(joint_state));
+    base::samples::RigidBodyStateSE3 rbs = robot_model->rigidBodyState(robot_model->worldFrame(), tip_frame);
+
+    vector<string> layout(joint_state.names.rbegin(), joint_state.names.rend());
+    uint n = layout.size();
+    base::VectorXd q(n), qd(n), qdd(n);
+    for(uint i = 0; i < n; i++){
+        q[i]   = joint_state[layout[i]].position;
+        qd[i]  = joint_state[layout[i]].speed;
+        qdd[i] = joint_state[layout[i]].acceleration;
+    }
+
+    // Without explicit binding, a named joint state in a different joint order is bound again automatically
+    base::samples::Joints joint_state_permuted;
+    joint_state_permuted.time = joint_state.time;
+    for(uint i = 0; i < n; i++)
+        joint_state_permuted.elements.push_back(joint_state[layout[i]]);
+    joint_state_permuted.names = layout;
+    BOOST_CHECK_NO_THROW(robot_model->update(joint_state_permuted));
+    const base::samples::RigidBodyStateSE3 &rbs_permuted = robot_model->rigidBodyState(robot_model->worldFrame(), tip_frame);
+    BOOST_CHECK(rbs.pose.position.isApprox(rbs_permuted.pose.position));
+    BOOST_CHECK(rbs.twist.linear.isApprox(rbs_permuted.twist.linear));
+
+    BOOST_CHECK_THROW(robot_model->bindJointStateLayout(vector<string>(layout.begin()+1, layout.end())), std::runtime_error);
+    robot_model->bindJointStateLayout(layout);
+    BOOST_CHECK_NO_THROW(robot_model->update(q, qd, qdd, joint_state.time));
+    BOOST_CHECK_THROW(robot_model->update(q.head(n-1), qd, qdd, joint_state.time), std::invalid_argument);
+
+    const base::samples::RigidBodyStateSE3 &rbs_raw = robot_model->rigidBodyState(robot_model->worldFrame(), tip_frame);
+    BOOST_CHECK(rbs.pose.position.isApprox(rbs_raw.pose.position));
+    BOOST_CHECK(rbs.twist.linear.isApprox(rbs_raw.twist.linear));
+    BOOST_CHECK(rbs.acceleration.linear.isApprox(rbs_raw.acceleration.linear));
+}
+
+BOOST_AUTO_TEST_CASE(cache_invalidation){
+
+    /**
+     * Verify that cached quantities are recomputed after each call to update()
+     */
+
+    string urdf_file = "../../../../../models/kuka/urdf/kuka_iiwa.urdf";
+    string tip_frame = "kuka_lbr_l_tcp";
+
+    RobotModelPtr robot_model = make_shared<RobotModelPinocchio>();
+    RobotModelConfig cfg(urdf_file);
+    BOOST_CHECK(robot_model->configure(cfg));
+    uint handle = robot_model->registerChain(robot_model->worldFrame(), tip_frame);
+
+    BOOST_CHECK_NO_THROW(robot_model->update(makeRandomJointState(robot_model->actuatedJointNames())));
+    base::MatrixXd M = robot_model->jointSpaceInertiaMatrix();
+    base::VectorXd h = robot_model->biasForces();
+    base::MatrixXd J = robot_model->spaceJacobian(handle);
+    base::Vector3d com = robot_model->centerOfMass().pose.position;
+    BOOST_CHECK(M.isApprox(robot_model->jointSpaceInertiaMatrix()));
+    BOOST_CHECK(h.isApprox(robot_model->biasForces()));
+    BOOST_CHECK(J.isApprox(robot_model->spaceJacobian(handle)));
+
+    BOOST_CHECK_NO_THROW(robot_model->update(makeRandomJointState(robot_model->actuatedJointNames())));
+    BOOST_CHECK(!M.isApprox(robot_model->jointSpaceInertiaMatrix()));
+    BOOST_CHECK(!h.isApprox(robot_model->biasForces()));
+    BOOST_CHECK(!J.isApprox(robot_model->spaceJacobian(handle)));
+    BOOST_CHECK(!com.isApprox(robot_model->centerOfMass().pose.position));
+}
+
+BOOST_AUTO_TEST_CASE(model_cache){
+
+    /**
+     * Verify that a robot model restored from the model cache is identical to the one built from URDF
+     */
+
+    string urdf_file = "../../../../../models/kuka/urdf/kuka_iiwa.urdf";
+    string tip_frame = "kuka_lbr_l_tcp";
+    string cache_dir = "/tmp/wbc_test_model_cache_" + to_string(getpid());
+
+    RobotModelConfig cfg(urdf_file);
+    cfg.floating_base = true;
+    cfg.contact_points.names.push_back(tip_frame);
+    cfg.contact_points.elements.push_back(ActiveContact(1,0.6));
+    cfg.model_cache_dir = cache_dir;
+
+    RobotModelPtr robot_model_urdf = make_shared<RobotModelPinocchio>();
+    BOOST_CHECK(robot_model_urdf->configure(cfg));
+    RobotModelPtr robot_model_cache = make_shared<RobotModelPinocchio>();
+    BOOST_CHECK(robot_model_cache->configure(cfg));
+
+    BOOST_CHECK(robot_model_urdf->jointNames() == robot_model_cache->jointNames());
+    BOOST_CHECK(robot_model_urdf->worldFrame() == robot_model_cache->worldFrame());
+    BOOST_CHECK(robot_model_urdf->baseFrame() == robot_model_cache->baseFrame());
+    BOOST_CHECK(robot_model_urdf->jointLimits().names == robot_model_cache->jointLimits().names);
+    BOOST_CHECK(robot_model_cache->hasLink(tip_frame));
+
+    base::samples::Joints joint_state = makeRandomJointState(robot_model_urdf->actuatedJointNames());
+    base::samples::RigidBodyStateSE3 floating_base_state = makeRandomFloatingBaseState();
+    robot_model_urdf->update(joint_state, floating_base_state);
+    robot_model_cache->update(joint_state, floating_base_state);
+    BOOST_CHECK(robot_model_urdf->spaceJacobian(robot_model_urdf->worldFrame(), tip_frame).isApprox(
+                robot_model_cache->spaceJacobian(robot_model_cache->worldFrame(), tip_frame)));
+    BOOST_CHECK(robot_model_urdf->jointSpaceInertiaMatrix().isApprox(robot_model_cache->jointSpaceInertiaMatrix()));
+
+    boost::filesystem::remove_all(cache_dir);
+}
@@ -49,12 +49,10 @@ bool RobotModelRBDL::configure(const RobotModelConfig& cfg){
         if(l.second->inertial)
             l.second->inertial->origin.rotation.setFromRPY(0,0,0);
     }
-    TiXmlDocument *doc = urdf::exportURDF(robot_urdf);
-    std::string robot_urdf_file = "/tmp/robot.urdf";
-    doc->SaveFile(robot_urdf_file);
-
-    if(!Addons::URDFReadFromFile(robot_urdf_file.c_str(), rbdl_model.get(), cfg.floating_base)){
-        LOG_ERROR_S << "Unable to parse urdf from file " << robot_urdf_file << std::endl;
+    // Load the modified model directly from memory
+    std::string robot_urdf_string = URDFTools::URDFToString(robot_urdf);
+    if(!Addons::URDFReadFromString(robot_urdf_string.c_str(), rbdl_model.get(), cfg.floating_base)){
+        LOG_ERROR_S << "Unable to parse urdf model " << cfg.file_or_string << std::endl;
         return false;
     }
 
@@ -125,19 +123,8 @@ bool RobotModelRBDL::configure(const RobotModelConfig& cfg){
 void RobotModelRBDL::update(const base::samples::Joints& joint_state_in,
                             const base::samples::RigidBodyStateSE3& floating_base_state_in){
 
-    if(joint_state_in.elements.size() != joint_state_in.names.size()){
-        LOG_ERROR_S << "Size of names and size of elements in joint state do not match"<<std::endl;
-        throw std::runtime_error("Invalid joint state");
-    }
-
-    if(joint_state_in.time.isNull()){
-        LOG_ERROR_S << "Joint State does not have a valid timestamp. Or do we have 1970?"<<std::endl;
-        throw std::runtime_error("Invalid joint state");
-    }
-
-    for(auto n : actuated_joint_names)
-        joint_state[n] = joint_state_in[n];
-    joint_state.time = joint_state_in.time;
+    invalidateCache();
+    updateJointState(joint_state_in);
 
     uint start_idx = 0;
     if(has_floating_base){
@@ -178,26 +165,21 @@ void RobotModelRBDL::update(const base::samples::Joints& joint_state_in,
         rbdl_model->SetQuaternion(floating_body_id, Math::Quaternion(floating_base_state_in.pose.orientation.coeffs()), q);
 
         base::Vector3d euler = floating_base_state.pose.orientation.toRotationMatrix().eulerAngles(0, 1, 2);
+        // The floating base joints are the first 6 entries in joint_state
         for(int i = 0; i < 3; i++){
-            q[i] = joint_state[joint_names_floating_base[i]].position = floating_base_state.pose.position[i];
-            qd[i] = joint_state[joint_names_floating_base[i]].speed = fb_twist.linear[i];
-            qdd[i] = joint_state[joint_names_floating_base[i]].acceleration = fb_acc.linear[i];
-            joint_state[joint_names_floating_base[i+3]].position = euler(i);
-            qd[i+3] = joint_state[joint_names_floating_base[i+3]].speed = fb_twist.angular[i];
-            qdd[i+3] = joint_state[joint_names_floating_base[i+3]].acceleration = fb_acc.angular[i];
+            q[i] = joint_state.elements[i].position = floating_base_state.pose.position[i];
+            qd[i] = joint_state.elements[i].speed = fb_twist.linear[i];
+            qdd[i] = joint_state.elements[i].acceleration = fb_acc.linear[i];
+            joint_state.elements[i+3].position = euler(i);
+            qd[i+3] = joint_state.elements[i+3].speed = fb_twist.angular[i];
+            qdd[i+3] = joint_state.elements[i+3].acceleration = fb_acc.angular[i];
         }
         if(floating_base_state.time > joint_state.time)
             joint_state.time = floating_base_state.time;
     }
 
-    for(int i = 0; i < actuated_joint_names.size(); i++){
-        const std::string &name = actuated_joint_names[i];
-        if(!hasJoint(name)){
-            LOG_ERROR_S << "Joint " << name << " is a non-fixed joint in the robot model, but it is not in the joint state vector."
-                        << "You should either set the joint to 'fixed' in your URDF file or provide a valid joint state for it" << std::endl;
-            throw std::runtime_error("Incomplete Joint State");
-        }
-        const base::JointState& state = joint_state[name];
+    for(int i = 0; i < actuated_joint_indices.size(); i++){
+        const base::JointState& state = joint_state.elements[actuated_joint_indices[i]];
         q[i+start_idx] = state.position;
         qd[i+start_idx] = state.speed;
         qdd[i+start_idx] = state.acceleration;
@@ -322,6 +304,9 @@ const base::MatrixXd &RobotModelRBDL::comJacobian(){
         LOG_ERROR("You have to call update() with appropriately timestamped joint data at least once before requesting kinematic information!");
         throw std::runtime_error(" Invalid call to spatialAccelerationBias()");
     }
+
+    if(com_jac_valid)
+        return com_jac;
     com_jac.setZero(3, rbdl_model->dof_count);
     double total_mass = 0.0;
 
@@ -337,6 +322,7 @@ const base::MatrixXd &RobotModelRBDL::comJacobian(){
     }
 
     com_jac = (1/total_mass) * com_jac;
+    com_jac_valid = true;
     return com_jac;
 }
 
@@ -376,9 +362,13 @@ const base::MatrixXd &RobotModelRBDL::jointSpaceInertiaMatrix(){
         LOG_ERROR("You have to call update() with appropriately timestamped joint data at least once before requesting kinematic information!");
         throw std::runtime_error(" Invalid call to jointSpaceInertiaMatrix()");
     }
+
+    if(joint_space_inertia_mat_valid)
+        return joint_space_inertia_mat;
     H_q.setZero(rbdl_model->dof_count, rbdl_model->dof_count);
     CompositeRigidBodyAlgorithm(*rbdl_model, q, H_q, false);
     joint_space_inertia_mat = H_q;
+    joint_space_inertia_mat_valid = true;
     return joint_space_inertia_mat;
 }
 
@@ -387,9 +377,13 @@ const base::VectorXd &RobotModelRBDL::biasForces(){
         LOG_ERROR("You have to call update() with appropriately timestamped joint data at least once before requesting kinematic information!");
         throw std::runtime_error(" Invalid call to biasForces()");
     }
+
+    if(bias_forces_valid)
+        return bias_forces;
     tau.resize(rbdl_model->dof_count);
     InverseDynamics(*rbdl_model, q, qd, Math::VectorNd::Zero(rbdl_model->dof_count), tau);
     bias_forces = tau;
+    bias_forces_valid = true;
     return bias_forces;
 }
 
@@ -399,6 +393,9 @@ const base::samples::RigidBodyStateSE3& RobotModelRBDL::centerOfMass(){
         throw std::runtime_error(" Invalid call to centerOfMass()");
     }
 
+    if(com_valid)
+        return com_rbs;
+
     double mass;
     Math::Vector3d com_pos, com_vel, com_acc;
     Utils::CalcCenterOfMass(*rbdl_model, q, qd, &qdd, mass, com_pos, &com_vel, &com_acc, nullptr, nullptr, false);
@@ -411,6 +408,7 @@ const base::samples::RigidBodyStateSE3& RobotModelRBDL::centerOfMass(){
     com_rbs.acceleration.linear = com_acc; // TODO: double check CoM acceleration
     com_rbs.acceleration.angular.setZero();
     com_rbs.time = joint_state.time;
+    com_valid = true;
     return com_rbs;
 }
 
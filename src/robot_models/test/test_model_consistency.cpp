@@ -172,6 +172,21 @@ void compareRobotModels(RobotModelConfig cfg, string tip_frame, bool verbose = f
         cout << Jb_hyrodyn << endl << endl;
     }
 
+    // Jacobian derivative (not implemented in RBDL and Hyrodyn)
+
+    base::MatrixXd Jdot_kdl = robot_model_kdl.jacobianDot(robot_model_kdl.worldFrame(), tip_frame);
+    base::MatrixXd Jdot_pinocchio = robot_model_pinocchio.jacobianDot(robot_model_pinocchio.worldFrame(), tip_frame);
+
+    compareJacobian(Jdot_kdl,Jdot_pinocchio,robot_model_kdl.jointNames(), robot_model_pinocchio.jointNames(), cfg.floating_base);
+
+    if(verbose){
+        cout << "---------------- Jacobian Derivative ----------------" << endl << endl;
+        cout<< " .......... RobotModelKDL .........." << endl ;
+        cout << Jdot_kdl << endl << endl;
+        cout<< " .......... RobotModelPinocchio .........." << endl;
+        cout << Jdot_pinocchio << endl << endl;
+    }
+
     // CoM Jacobian
 
     base::MatrixXd Jcom_kdl = robot_model_kdl.comJacobian();
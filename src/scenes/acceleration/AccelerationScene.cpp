@@ -41,6 +41,7 @@ const HierarchicalQP& AccelerationScene::update(){
     int prio = 0; // Only one priority is implemented here!
     QuadraticProgram &qp = hqp[prio];
     qp.resize(robot_model->noOfJoints(), n_task_variables_per_prio[prio], 0, false);
+    qp.soft_constraints = true;
 
     ///////// Constraints
 
@@ -56,14 +57,19 @@ const HierarchicalQP& AccelerationScene::update(){
 
     ///////// Tasks
 
+    double t_hessian = 0;
+    TimingStats::Clock::time_point start = TimingStats::Clock::now();
     qp.H.setZero();
     qp.g.setZero();
+    t_hessian += TimingStats::elapsed(start);
     for(uint i = 0; i < tasks[prio].size(); i++){
 
         TaskPtr task = tasks[prio][i];
 
+        start = TimingStats::Clock::now();
         task->checkTimeout();
         task->update(robot_model);
+        taskTiming(prio,i).add(start);
 
         // If the activation value is zero, also set reference to zero. Activation is usually used to switch between different
         // task phases and we don't want to store the "old" reference value, in case we switch on the task again
@@ -72,17 +78,16 @@ const HierarchicalQP& AccelerationScene::update(){
            task->y_ref_root.setZero();
         }
 
-        for(int i = 0; i < task->A.rows(); i++)
-            task->Aw.row(i) = task->weights_root(i) * task->A.row(i) * task->activation * (!task->timeout);
-        for(int i = 0; i < task->A.cols(); i++)
-            task->Aw.col(i) = joint_weights[i] * task->Aw.col(i);
+        start = TimingStats::Clock::now();
+        weightTask(*task);
 
-        qp.H += task->Aw.transpose()*task->Aw;
-        qp.g -= task->Aw.transpose()*task->y_ref_root;
+        addTaskToCost(*task, qp.H, qp.g);
+        t_hessian += TimingStats::elapsed(start);
     }
+    timing_stats[timing_hessian_assembly].add(t_hessian);
 
     hqp.time = base::Time::now(); //  TODO: Use latest time stamp from all tasks!?
-    hqp.Wq = base::VectorXd::Map(joint_weights.elements.data(), robot_model->noOfJoints());
+    hqp.Wq = joint_weights_vector;
     return hqp;
 }
 
@@ -90,19 +95,21 @@ const base::commands::Joints& AccelerationScene::solve(const HierarchicalQP& hqp
 
     // solve
     solver_output.resize(hqp[0].nq);
+    TimingStats::Clock::time_point start = TimingStats::Clock::now();
     solver->solve(hqp, solver_output);
+    timing_stats[timing_solver].add(start);
+    start = TimingStats::Clock::now();
 
-    // Convert Output
-    solver_output_joints.resize(robot_model->noOfActuatedJoints());
-    solver_output_joints.names = robot_model->actuatedJointNames();
+    // Convert Output. Note: solver_output_joints is allocated in configure()
     for(uint i = 0; i < robot_model->noOfActuatedJoints(); i++){
         const std::string& name = robot_model->actuatedJointNames()[i];
-        uint idx = robot_model->jointIndex(name);
+        uint idx = actuated_joint_indices[i];
         if(base::isNaN(solver_output[idx]))
             throw std::runtime_error("Solver output (acceleration) for joint " + name + " is NaN");
-        solver_output_joints[name].acceleration = solver_output[idx];
+        solver_output_joints[i].acceleration = solver_output[idx];
     }
     solver_output_joints.time = base::Time::now();
+    timing_stats[timing_output_conversion].add(start);
     return solver_output_joints;
 }
 
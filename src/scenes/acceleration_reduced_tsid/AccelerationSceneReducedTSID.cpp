@@ -48,6 +48,13 @@ TaskPtr AccelerationSceneReducedTSID::createTask(const TaskConfig &config){
     }
 }
 
+bool AccelerationSceneReducedTSID::configure(const std::vector<TaskConfig> &config){
+    // The robot model might have been reconfigured, so drop the cached contact chain handles
+    contact_names.clear();
+    contact_handles.clear();
+    return Scene::configure(config);
+}
+
 const HierarchicalQP& AccelerationSceneReducedTSID::update(){
 
     if(!configured)
@@ -62,12 +69,24 @@ const HierarchicalQP& AccelerationSceneReducedTSID::update(){
     uint nj = robot_model->noOfJoints();
     uint ncp = robot_model->getActiveContacts().size();
 
+    ///////// Robot model
+
+    // Evaluate the dynamics quantities, which are shared by multiple constraints. The robot model caches them
+    // until its next update, so the constraints can query them at no additional cost
+    TimingStats::Clock::time_point start = TimingStats::Clock::now();
+    robot_model->jointSpaceInertiaMatrix();
+    robot_model->biasForces();
+    timing_stats[timing_dynamics].add(start);
+
     //////// Constraints
 
     bool has_bounds = false;
     size_t total_eqs = 0, total_ineqs = 0;
-    for(auto contraint : constraints[prio]) {
+    for(uint i = 0; i < constraints[prio].size(); i++) {
+        ConstraintPtr contraint = constraints[prio][i];
+        start = TimingStats::Clock::now();
         contraint->update(robot_model);
+        constraintTiming(prio,i).add(start);
         if(contraint->type() == Constraint::equality)
             total_eqs += contraint->size();
         if(contraint->type() == Constraint::inequality)
@@ -79,7 +98,7 @@ const HierarchicalQP& AccelerationSceneReducedTSID::update(){
     // QP Size: (nc x nj+nc*6)
     // Variable order: (qdd,f_ext)
     QuadraticProgram& qp = hqp[prio];
-    qp.resize(nj+ncp*6, total_eqs, total_ineqs, has_bounds);
+    qp.resize(nj+ncp*6, total_eqs, total_ineqs, has_bounds, solver->constraintStaging());
     qp.A.setZero();
     qp.lower_x.setConstant(-10000);   // bounds
     qp.upper_x.setConstant(+10000);   // bounds
@@ -96,28 +115,30 @@ const HierarchicalQP& AccelerationSceneReducedTSID::update(){
             qp.upper_x = constraints[prio][i]->ub();
         }
         else if (type == Constraint::equality) {
-            qp.A.middleRows(total_eqs, c_size) = constraints[prio][i]->A();
-            qp.b.segment(total_eqs, c_size) = constraints[prio][i]->b();
+            qp.setEqualityConstraints(total_eqs, constraints[prio][i]->A(), constraints[prio][i]->b());
             total_eqs += c_size;
         }
         else if (type == Constraint::inequality) {
-            qp.C.middleRows(total_ineqs, c_size) = constraints[prio][i]->A();
-            qp.lower_y.segment(total_ineqs, c_size) = constraints[prio][i]->lb();
-            qp.upper_y.segment(total_ineqs, c_size) = constraints[prio][i]->ub();
+            qp.setInequalityConstraints(total_ineqs, constraints[prio][i]->A(), constraints[prio][i]->lb(), constraints[prio][i]->ub());
             total_ineqs += c_size;
         }
     }
 
     ///////// Tasks
 
+    double t_hessian = 0;
+    start = TimingStats::Clock::now();
     qp.H.setZero();
     qp.g.setZero();
+    t_hessian += TimingStats::elapsed(start);
     for(uint i = 0; i < tasks[prio].size(); i++){
         
         TaskPtr task = tasks[prio][i];
 
+        start = TimingStats::Clock::now();
         task->checkTimeout();
         task->update(robot_model);
+        taskTiming(prio,i).add(start);
 
         // If the activation value is zero, also set reference to zero. Activation is usually used to switch between different
         // task phases and we don't want to store the "old" reference value, in case we switch on the task again
@@ -126,19 +147,19 @@ const HierarchicalQP& AccelerationSceneReducedTSID::update(){
            task->y_ref_root.setZero();
         }
 
-        for(int i = 0; i < task->A.rows(); i++)
-            task->Aw.row(i) = task->weights_root(i) * task->A.row(i) * task->activation * (!task->timeout);
-        for(int i = 0; i < task->A.cols(); i++)
-            task->Aw.col(i) = joint_weights[i] * task->Aw.col(i);
+        start = TimingStats::Clock::now();
+        weightTask(*task);
 
-        qp.H.block(0,0,nj,nj) += task->Aw.transpose()*task->Aw; // NOTE! good only if tasks involve only acceleration
-        qp.g.segment(0,nj) -= task->Aw.transpose()*task->y_ref_root;
+        addTaskToCost(*task, qp.H.block(0,0,nj,nj), qp.g.segment(0,nj)); // NOTE! good only if tasks involve only acceleration
+        t_hessian += TimingStats::elapsed(start);
     }
 
+    start = TimingStats::Clock::now();
     qp.H.block(0,0, nj, nj).diagonal().array() += hessian_regularizer;
     qp.H.block(nj,nj, ncp*6, ncp*6).diagonal().array() += 1e-12;
+    timing_stats[timing_hessian_assembly].add(t_hessian + TimingStats::elapsed(start));
 
-    hqp.Wq = base::VectorXd::Map(joint_weights.elements.data(), robot_model->noOfJoints());
+    hqp.Wq = joint_weights_vector;
     hqp.time = base::Time::now(); //  TODO: Use latest time stamp from all tasks!?
     return hqp;
 }
@@ -147,7 +168,10 @@ const base::commands::Joints& AccelerationSceneReducedTSID::solve(const Hierarch
 
     // solve
     solver_output.resize(hqp[0].nq);
+    TimingStats::Clock::time_point start = TimingStats::Clock::now();
     solver->solve(hqp, solver_output);
+    timing_stats[timing_solver].add(start);
+    start = TimingStats::Clock::now();
 
     const auto& contacts = robot_model->getActiveContacts();
 
@@ -160,16 +184,24 @@ const base::commands::Joints& AccelerationSceneReducedTSID::solve(const Hierarch
     auto fext_out = Eigen::Map<Eigen::VectorXd>(solver_output.data()+nj, 6*nc);
 
     // computing torques from accelerations and forces (using last na equation from dynamic equations of motion)
-    Eigen::VectorXd tau_out = robot_model->jointSpaceInertiaMatrix().bottomRows(na) * qdd_out;
-    for(uint c = 0; c < nc; ++c)
-        tau_out += -robot_model->bodyJacobian(robot_model->worldFrame(), contacts.names[c]).transpose().bottomRows(na) * fext_out.segment<6>(c*6);
+    tau_out.resize(na);
+    tau_out.noalias() = robot_model->jointSpaceInertiaMatrix().bottomRows(na) * qdd_out;
+    // The contact chains are only registered again if the active contacts change, so that the Jacobians are queried by handle
+    if(contact_names != contacts.names){
+        contact_handles.resize(nc);
+        for(uint c = 0; c < nc; c++)
+            contact_handles[c] = robot_model->registerChain(robot_model->worldFrame(), contacts.names[c]);
+        contact_names = contacts.names;
+    }
+    if(contact_jacobians.rows() != nc*6 || contact_jacobians.cols() != nj)
+        contact_jacobians.resize(nc*6, nj);
+    robot_model->bodyJacobians(contact_handles, contact_jacobians);
+    tau_out.noalias() -= contact_jacobians.rightCols(na).transpose() * fext_out;
     tau_out += robot_model->biasForces().bottomRows(na);
 
-    solver_output_joints.resize(robot_model->noOfActuatedJoints());
-    solver_output_joints.names = robot_model->actuatedJointNames();
     for(uint i = 0; i < robot_model->noOfActuatedJoints(); i++){
         const std::string& name = robot_model->actuatedJointNames()[i];
-        uint idx = robot_model->jointIndex(name);
+        uint idx = actuated_joint_indices[i];
         if(base::isNaN(qdd_out[idx])){
             hqp[0].print();
             throw std::runtime_error("Solver output (acceleration) for joint " + name + " is NaN");
@@ -179,8 +211,8 @@ const base::commands::Joints& AccelerationSceneReducedTSID::solve(const Hierarch
             hqp[0].print();
             throw std::runtime_error("Solver output (force/torque) for joint " + name + " is NaN");
         }
-        solver_output_joints[name].acceleration = qdd_out[idx];
-        solver_output_joints[name].effort = tau_out[idx-start_idx]; // tau_out does not include fb dofs.
+        solver_output_joints[i].acceleration = qdd_out[idx];
+        solver_output_joints[i].effort = tau_out[idx-start_idx]; // tau_out does not include fb dofs.
     }
     solver_output_joints.time = base::Time::now();
 
@@ -189,14 +221,17 @@ const base::commands::Joints& AccelerationSceneReducedTSID::solve(const Hierarch
     // std::cerr << "F_ext: " << fext_out.transpose() << std::endl << std::endl;
 
     // Convert solver output: contact wrenches
-    contact_wrenches.resize(nc);
-    contact_wrenches.names = contacts.names;
+    if(contact_wrenches.names != contacts.names){
+        contact_wrenches.resize(nc);
+        contact_wrenches.names = contacts.names;
+    }
     for(uint i = 0; i < nc; i++){
         contact_wrenches[i].force = fext_out.segment(i*6, 3);
         contact_wrenches[i].torque = fext_out.segment(i*6+3, 3);
     }
 
     contact_wrenches.time = base::Time::now();
+    timing_stats[timing_output_conversion].add(start);
     return solver_output_joints;
 }
 
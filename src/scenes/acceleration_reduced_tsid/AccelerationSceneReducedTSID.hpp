@@ -41,9 +41,12 @@ protected:
     static SceneRegistry<AccelerationSceneReducedTSID> reg;
 
     // Helper variables
-    base::VectorXd robot_acc, solver_output_acc;
+    base::VectorXd robot_acc, solver_output_acc, tau_out;
     base::samples::Wrenches contact_wrenches;
     double hessian_regularizer;
+    std::vector<std::string> contact_names; /** Names of the active contacts the handles in contact_handles were registered for*/
+    std::vector<uint> contact_handles;      /** Handles of the kinematic chains world frame -> contact point*/
+    base::MatrixXd contact_jacobians;       /** Stacked body Jacobians of all active contacts (6*nc x nj)*/
 
     /**
      * brief Create a task and add it to the WBC scene
@@ -56,6 +59,12 @@ public:
     AccelerationSceneReducedTSID(RobotModelPtr robot_model, QPSolverPtr solver, const double dt);
     virtual ~AccelerationSceneReducedTSID(){}
 
+    /**
+     * @brief Configure the WBC scene. Create tasks and sort them by priority. Clears the cached contact chain handles
+     * @param config configuration. Size has to be > 0. All tasks have to be valid. See TaskConfig.hpp for more details.
+     */
+    virtual bool configure(const std::vector<TaskConfig> &config);
+
     /**
      * @brief Update the wbc scene and return the (updated) optimization problem
      * @param ctrl_output Control solution that fulfill the given tasks as good as possible
@@ -60,22 +60,34 @@ const HierarchicalQP& AccelerationSceneTSID::update(){
     uint na = robot_model->noOfActuatedJoints();
     uint ncp = robot_model->getActiveContacts().size();
 
+    ///////// Robot model
+
+    // Evaluate the dynamics quantities, which are shared by multiple constraints. The robot model caches them
+    // until its next update, so the constraints can query them at no additional cost
+    TimingStats::Clock::time_point start = TimingStats::Clock::now();
+    robot_model->jointSpaceInertiaMatrix();
+    robot_model->biasForces();
+    timing_stats[timing_dynamics].add(start);
+
     ///////// Constraints
 
     bool has_bounds = false;
     size_t total_eqs = 0, total_ineqs = 0;
-    for(auto contraint : constraints[prio]) {
+    for(uint i = 0; i < constraints[prio].size(); i++) {
+        ConstraintPtr contraint = constraints[prio][i];
+        start = TimingStats::Clock::now();
         contraint->update(robot_model);
+        constraintTiming(prio,i).add(start);
         if(contraint->type() == Constraint::equality)
             total_eqs += contraint->size();
         if(contraint->type() == Constraint::inequality)
             total_ineqs += contraint->size();
         if(contraint->type() == Constraint::bounds)
-            has_bounds = true;;
+            has_bounds = true;
     }
 
     QuadraticProgram& qp = hqp[prio];
-    qp.resize(nj+na+ncp*6, total_eqs, total_ineqs, has_bounds);
+    qp.resize(nj+na+ncp*6, total_eqs, total_ineqs, has_bounds, solver->constraintStaging());
     total_eqs = total_ineqs = 0;
     for(uint i = 0; i < constraints[prio].size(); i++) {
         Constraint::Type type = constraints[prio][i]->type();
@@ -86,28 +98,30 @@ const HierarchicalQP& AccelerationSceneTSID::update(){
             qp.upper_x = constraints[prio][i]->ub();
         }
         else if (type == Constraint::equality) {
-            qp.A.middleRows(total_eqs, c_size) = constraints[prio][i]->A();
-            qp.b.segment(total_eqs, c_size) = constraints[prio][i]->b();
+            qp.setEqualityConstraints(total_eqs, constraints[prio][i]->A(), constraints[prio][i]->b());
             total_eqs += c_size;
         }
         else if (type == Constraint::inequality) {
-            qp.C.middleRows(total_ineqs, c_size) = constraints[prio][i]->A();
-            qp.lower_y.segment(total_ineqs, c_size) = constraints[prio][i]->lb();
-            qp.upper_y.segment(total_ineqs, c_size) = constraints[prio][i]->ub();
+            qp.setInequalityConstraints(total_ineqs, constraints[prio][i]->A(), constraints[prio][i]->lb(), constraints[prio][i]->ub());
             total_ineqs += c_size;
         }
     }
 
     ///////// Tasks
 
+    double t_hessian = 0;
+    start = TimingStats::Clock::now();
     qp.H.setZero();
     qp.g.setZero();
+    t_hessian += TimingStats::elapsed(start);
     for(uint i = 0; i < tasks[prio].size(); i++){
         
         TaskPtr task = tasks[prio][i];
 
+        start = TimingStats::Clock::now();
         task->checkTimeout();
         task->update(robot_model);
+        taskTiming(prio,i).add(start);
 
         // If the activation value is zero, also set reference to zero. Activation is usually used to switch between different
         // task phases and we don't want to store the "old" reference value, in case we switch on the task again
@@ -116,18 +130,18 @@ const HierarchicalQP& AccelerationSceneTSID::update(){
            task->y_ref_root.setZero();
         }
 
-        for(int i = 0; i < task->A.rows(); i++)
-            task->Aw.row(i) = task->weights_root(i) * task->A.row(i) * task->activation * (!task->timeout);
-        for(int i = 0; i < task->A.cols(); i++)
-            task->Aw.col(i) = joint_weights[i] * task->Aw.col(i);
+        start = TimingStats::Clock::now();
+        weightTask(*task);
 
-        qp.H.block(0,0,nj,nj) += task->Aw.transpose()*task->Aw;
-        qp.g.segment(0,nj) -= task->Aw.transpose()*task->y_ref_root;
+        addTaskToCost(*task, qp.H.block(0,0,nj,nj), qp.g.segment(0,nj));
+        t_hessian += TimingStats::elapsed(start);
     }
 
+    start = TimingStats::Clock::now();
     qp.H.block(0,0, nj, nj).diagonal().array() += hessian_regularizer;
+    timing_stats[timing_hessian_assembly].add(t_hessian + TimingStats::elapsed(start));
 
-    hqp.Wq = base::VectorXd::Map(joint_weights.elements.data(), robot_model->noOfJoints());
+    hqp.Wq = joint_weights_vector;
     hqp.time = base::Time::now(); //  TODO: Use latest time stamp from all tasks!?
     return hqp;
 }
@@ -136,16 +150,17 @@ const base::commands::Joints& AccelerationSceneTSID::solve(const HierarchicalQP&
 
     // solve
     solver_output.resize(hqp[0].nq);
+    TimingStats::Clock::time_point start = TimingStats::Clock::now();
     solver->solve(hqp, solver_output);
+    timing_stats[timing_solver].add(start);
+    start = TimingStats::Clock::now();
 
     // Convert solver output: Acceleration and torque
     uint nj = robot_model->noOfJoints();
     uint na = robot_model->noOfActuatedJoints();
-    solver_output_joints.resize(robot_model->noOfActuatedJoints());
-    solver_output_joints.names = robot_model->actuatedJointNames();
     for(uint i = 0; i < robot_model->noOfActuatedJoints(); i++){
         const std::string& name = robot_model->actuatedJointNames()[i];
-        uint idx = robot_model->jointIndex(name);
+        uint idx = actuated_joint_indices[i];
         if(base::isNaN(solver_output[idx])){
             hqp[0].print();
             throw std::runtime_error("Solver output (acceleration) for joint " + name + " is NaN");
@@ -154,9 +169,9 @@ const base::commands::Joints& AccelerationSceneTSID::solve(const HierarchicalQP&
             hqp[0].print();
             throw std::runtime_error("Solver output (force/torque) for joint " + name + " is NaN");
         }
-        solver_output_joints[name].acceleration = solver_output.segment(0,nj)[idx];
+        solver_output_joints[i].acceleration = solver_output[idx];
         uint start_idx = robot_model->hasFloatingBase() ? 6 : 0;
-        solver_output_joints[name].effort = solver_output.segment(nj,na)[idx-start_idx];
+        solver_output_joints[i].effort = solver_output[nj+idx-start_idx];
     }
     solver_output_joints.time = base::Time::now();
 
@@ -165,14 +180,17 @@ const base::commands::Joints& AccelerationSceneTSID::solve(const HierarchicalQP&
     // std::cout<<"F_ext: "<<solver_output.segment(nj+na,12).transpose()<<std::endl<<std::endl;
 
     // Convert solver output: contact wrenches
-    contact_wrenches.resize(robot_model->getActiveContacts().size());
-    contact_wrenches.names = robot_model->getActiveContacts().names;
+    if(contact_wrenches.names != robot_model->getActiveContacts().names){
+        contact_wrenches.resize(robot_model->getActiveContacts().size());
+        contact_wrenches.names = robot_model->getActiveContacts().names;
+    }
     for(uint i = 0; i < robot_model->getActiveContacts().size(); i++){
         contact_wrenches[i].force = solver_output.segment(nj+na+i*6,3);
         contact_wrenches[i].torque = solver_output.segment(nj+na+i*6+3,3);
     }
 
     contact_wrenches.time = base::Time::now();
+    timing_stats[timing_output_conversion].add(start);
     return solver_output_joints;
 }
 
@@ -0,0 +1,150 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+#include "robot_models/pinocchio/RobotModelPinocchio.hpp"
+#include "scenes/velocity_qp/VelocitySceneQP.hpp"
+#include "scenes/acceleration_tsid/AccelerationSceneTSID.hpp"
+#include "scenes/acceleration_reduced_tsid/AccelerationSceneReducedTSID.hpp"
+
+using namespace std;
+using namespace wbc;
+
+// Wrap the glibc allocator to count all heap allocations (this includes operator new, which calls malloc internally)
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_calloc(size_t n, size_t size);
+extern "C" void* __libc_realloc(void* ptr, size_t size);
+
+static bool count_allocations = false;
+static size_t n_allocations = 0;
+
+extern "C" void* malloc(size_t size){
+    if(count_allocations)
+        n_allocations++;
+    return __libc_malloc(size);
+}
+
+extern "C" void* calloc(size_t n, size_t size){
+    if(count_allocations)
+        n_allocations++;
+    return __libc_calloc(n, size);
+}
+
+extern "C" void* realloc(void* ptr, size_t size){
+    if(count_allocations)
+        n_allocations++;
+    return __libc_realloc(ptr, size);
+}
+
+/**
+ * Dummy solver, which does not allocate any memory. Third party solvers may allocate memory internally (e.g. qpOASES in hotstart()),
+ * so we use this one to check only the allocations of the scene.
+ */
+class DummySolver : public QPSolver{
+public:
+    virtual void solve(const HierarchicalQP& hierarchical_qp, base::VectorXd &solver_output){
+        solver_output.setZero();
+    }
+};
+
+RobotModelPtr makeRobotModel(){
+    RobotModelPtr robot_model = make_shared<RobotModelPinocchio>();
+    RobotModelConfig config;
+    config.file_or_string = "../../../../models/rh5/urdf/rh5_legs.urdf";
+    config.floating_base = true;
+    config.contact_points.names = {"FL_SupportCenter", "FR_SupportCenter"};
+    wbc::ActiveContact contact(1,0.6);
+    contact.wx = 0.2;
+    contact.wy = 0.08;
+    config.contact_points.elements = {contact, contact};
+    BOOST_CHECK_EQUAL(robot_model->configure(config), true);
+    return robot_model;
+}
+
+void updateRobotModel(RobotModelPtr robot_model){
+    vector<double> q_in = {0,0,-0.35,0.64,0,-0.27,
+                           0,0,-0.35,0.64,0,-0.27};
+
+    base::samples::Joints joint_state;
+    joint_state.names = robot_model->actuatedJointNames();
+    for(uint i = 0; i < robot_model->noOfActuatedJoints(); i++){
+        base::JointState js;
+        js.position = q_in[i];
+        js.speed = js.acceleration = 0;
+        joint_state.elements.push_back(js);
+    }
+    joint_state.time = base::Time::now();
+
+    base::samples::RigidBodyStateSE3 rbs;
+    rbs.pose.position = base::Vector3d(-0.175,0,0.876);
+    rbs.pose.orientation.setIdentity();
+    rbs.twist.setZero();
+    rbs.acceleration.setZero();
+    rbs.time = base::Time::now();
+
+    BOOST_CHECK_NO_THROW(robot_model->update(joint_state,rbs));
+}
+
+void testAllocations(Scene& scene, RobotModelPtr robot_model){
+
+    TaskConfig cart_task;
+    cart_task.type = cart;
+    cart_task.name = "cart_pos_ctrl";
+    cart_task.root = "world";
+    cart_task.tip = "RH5_Root_Link";
+    cart_task.ref_frame = "world";
+    cart_task.weights = {1,1,1,1,1,1};
+    cart_task.priority = 0;
+    cart_task.activation = 1;
+    BOOST_CHECK_EQUAL(scene.configure({cart_task}), true);
+
+    base::samples::RigidBodyStateSE3 ref;
+    ref.twist.setZero();
+    ref.acceleration.setZero();
+    BOOST_CHECK_NO_THROW(scene.setReference(cart_task.name, ref));
+
+    // The first cycle is allowed to allocate memory
+    updateRobotModel(robot_model);
+    scene.solve(scene.update());
+
+    for(int i = 0; i < 10; i++){
+        updateRobotModel(robot_model);
+
+        n_allocations = 0;
+        count_allocations = true;
+        const HierarchicalQP& hqp = scene.update();
+        scene.solve(hqp);
+        count_allocations = false;
+
+        BOOST_CHECK_EQUAL(n_allocations, 0);
+    }
+
+    // Timing stats are recorded in each cycle (see above: recording does not allocate memory)
+    const TimingsStats& timings = scene.getTimingStats();
+    for(const std::string& stage : {"task:cart_pos_ctrl", "hessian_assembly", "solver", "output_conversion"}){
+        const TimingStats& t = timings[stage];
+        BOOST_CHECK_EQUAL(t.n_samples, 11);
+        BOOST_CHECK(t.min <= t.mean && t.mean <= t.max);
+        BOOST_CHECK(t.min <= t.p99() && t.p99() <= t.max);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(velocity_scene_qp){
+    RobotModelPtr robot_model = makeRobotModel();
+    updateRobotModel(robot_model);
+    VelocitySceneQP scene(robot_model, make_shared<DummySolver>(), 1e-3);
+    testAllocations(scene, robot_model);
+}
+
+BOOST_AUTO_TEST_CASE(acceleration_scene_tsid){
+    RobotModelPtr robot_model = makeRobotModel();
+    updateRobotModel(robot_model);
+    AccelerationSceneTSID scene(robot_model, make_shared<DummySolver>(), 1e-3);
+    testAllocations(scene, robot_model);
+}
+
+BOOST_AUTO_TEST_CASE(acceleration_scene_reduced_tsid){
+    RobotModelPtr robot_model = makeRobotModel();
+    updateRobotModel(robot_model);
+    AccelerationSceneReducedTSID scene(robot_model, make_shared<DummySolver>(), 1e-3);
+    testAllocations(scene, robot_model);
+}
@@ -38,10 +38,13 @@ const HierarchicalQP& VelocityScene::update(){
 
     // Note: This scene models all tasks as linear equality constraints in order to comply with the HLS solver
     uint nj = robot_model->noOfJoints();
+    double t_assembly = 0;
+    TimingStats::Clock::time_point start;
     for(uint prio = 0; prio < tasks.size(); prio++){
 
         uint nc = n_task_variables_per_prio[prio];
         hqp[prio].resize(nj, nc, 0, false);
+        hqp[prio].soft_constraints = true;
 
         // Walk through all tasks of current priority
         uint row_index = 0;
@@ -49,8 +52,10 @@ const HierarchicalQP& VelocityScene::update(){
 
             TaskPtr task = tasks[prio][i];
 
+            start = TimingStats::Clock::now();
             task->checkTimeout();
             task->update(robot_model);
+            taskTiming(prio,i).add(start);
             
             uint n_vars = task->config.nVariables();
 
@@ -63,23 +68,26 @@ const HierarchicalQP& VelocityScene::update(){
 
             // Insert tasks into equation system of current priority at the correct position. Note: Weights will be zero if activations
             // for this task is zero or if the task is in timeout
+            start = TimingStats::Clock::now();
             hqp[prio].Wy.segment(row_index, n_vars) = task->weights_root * task->activation * (!task->timeout);
             hqp[prio].A.block(row_index, 0, n_vars, robot_model->noOfJoints()) = task->A;
             hqp[prio].b.segment(row_index, n_vars) = task->y_ref_root;
-            hqp[prio].H.setIdentity();
+            hqp[prio].H.setZero(); // No cost besides the tasks, solvers that use H (e.g. hqp) would otherwise damp the task solution
             hqp[prio].lower_x.resize(0);
             hqp[prio].upper_x.resize(0);
             hqp[prio].g.setZero();
 
             row_index += n_vars;
+            t_assembly += TimingStats::elapsed(start);
 
         } // tasks on prio
     } // priorities
+    timing_stats[timing_hessian_assembly].add(t_assembly);
 
     hqp.time = base::Time::now(); //  TODO: Use latest time stamp from all tasks!?
 
     // Joint Weights
-    hqp.Wq = base::VectorXd::Map(joint_weights.elements.data(), robot_model->noOfJoints());
+    hqp.Wq = joint_weights_vector;
     return hqp;
 }
 
@@ -87,22 +95,24 @@ const base::commands::Joints& VelocityScene::solve(const HierarchicalQP& hqp){
 
     // solve
     solver_output.resize(hqp[0].nq);
+    TimingStats::Clock::time_point start = TimingStats::Clock::now();
     solver->solve(hqp, solver_output);
+    timing_stats[timing_solver].add(start);
+    start = TimingStats::Clock::now();
 
-    // Convert Output
-    solver_output_joints.resize(robot_model->noOfActuatedJoints());
-    solver_output_joints.names = robot_model->actuatedJointNames();
+    // Convert Output. Note: solver_output_joints is allocated in configure()
     for(uint i = 0; i < robot_model->noOfActuatedJoints(); i++){
         const std::string& name = robot_model->actuatedJointNames()[i];
-        uint idx = robot_model->jointIndex(name);
+        uint idx = actuated_joint_indices[i];
         if(base::isNaN(solver_output[idx])){
             hqp[0].print();
             throw std::runtime_error("Solver output (speed) for joint " + name + " is NaN");
         }
-        solver_output_joints[name].speed = solver_output[idx];
+        solver_output_joints[i].speed = solver_output[idx];
     }
 
     solver_output_joints.time = base::Time::now();
+    timing_stats[timing_output_conversion].add(start);
     return solver_output_joints;
 }
 
@@ -126,7 +136,7 @@ const TasksStatus& VelocityScene::updateTasksStatus(){
         }
     }
 
-    hqp.Wq = base::VectorXd::Map(joint_weights.elements.data(), robot_model->noOfJoints());
+    hqp.Wq = joint_weights_vector;
     return tasks_status;
 }
 
@@ -4,6 +4,7 @@
 #include "robot_models/pinocchio/RobotModelPinocchio.hpp"
 #include "scenes/velocity/VelocityScene.hpp"
 #include "solvers/hls/HierarchicalLSSolver.hpp"
+#include "solvers/hqp/HierarchicalQPSolver.hpp"
 
 using namespace std;
 using namespace wbc;
@@ -93,3 +94,59 @@ BOOST_AUTO_TEST_CASE(simple_test){
         BOOST_CHECK(fabs(status[0].y_ref[i+3] - status[0].y_solution[i]) < 1e5);
     }
 }
+
+BOOST_AUTO_TEST_CASE(compare_hls_hqp){
+
+    /**
+     * Check if the hierarchical QP solver computes the same solution as the hierarchical least squares solver for a velocity scene with two
+     * conflicting priority levels
+     */
+
+    shared_ptr<RobotModelPinocchio> robot_model = make_shared<RobotModelPinocchio>();
+    RobotModelConfig config;
+    config.file_or_string = "../../../../../models/kuka/urdf/kuka_iiwa.urdf";
+    BOOST_CHECK(robot_model->configure(config));
+
+    base::samples::Joints joint_state;
+    joint_state.names = robot_model->jointNames();
+    for(auto n : robot_model->jointNames()){
+        base::JointState js;
+        js.position = 0.5;
+        joint_state.elements.push_back(js);
+    }
+    joint_state.time = base::Time::now();
+    BOOST_CHECK_NO_THROW(robot_model->update(joint_state));
+
+    TaskConfig cart_task("cart_pos_ctrl_left", 0, "kuka_lbr_l_link_0", "kuka_lbr_l_tcp", "kuka_lbr_l_link_0", 1);
+    TaskConfig jnt_task("jnt_pos_ctrl", 1, robot_model->actuatedJointNames(), vector<double>(robot_model->noOfActuatedJoints(), 1), 1);
+
+    base::samples::RigidBodyStateSE3 cart_ref;
+    cart_ref.twist.linear = base::Vector3d(0.1, -0.2, 0.05);
+    cart_ref.twist.angular = base::Vector3d(0.0, 0.1, -0.1);
+    base::samples::Joints jnt_ref;
+    jnt_ref.names = robot_model->actuatedJointNames();
+    for(uint i = 0; i < robot_model->noOfActuatedJoints(); i++){
+        base::JointState js;
+        js.speed = 0.1*i;
+        jnt_ref.elements.push_back(js);
+    }
+
+    std::shared_ptr<HierarchicalLSSolver> hls_solver = std::make_shared<HierarchicalLSSolver>();
+    hls_solver->setMaxSolverOutputNorm(1000);
+    vector<QPSolverPtr> solvers = {hls_solver, std::make_shared<HierarchicalQPSolver>()};
+    vector<base::commands::Joints> solver_outputs;
+    for(QPSolverPtr solver : solvers){
+        VelocityScene wbc_scene(robot_model, solver, 1e-3);
+        BOOST_CHECK_EQUAL(wbc_scene.configure({cart_task, jnt_task}), true);
+        BOOST_CHECK_NO_THROW(wbc_scene.setReference(cart_task.name, cart_ref));
+        BOOST_CHECK_NO_THROW(wbc_scene.setReference(jnt_task.name, jnt_ref));
+        BOOST_CHECK_NO_THROW(wbc_scene.update());
+        HierarchicalQP qp;
+        wbc_scene.getHierarchicalQP(qp);
+        BOOST_CHECK_NO_THROW(wbc_scene.solve(qp));
+        solver_outputs.push_back(wbc_scene.getSolverOutput());
+    }
+
+    for(uint i = 0; i < robot_model->noOfActuatedJoints(); i++)
+        BOOST_CHECK(fabs(solver_outputs[0][i].speed - solver_outputs[1][i].speed) < 1e-4);
+}
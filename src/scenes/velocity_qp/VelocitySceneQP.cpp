@@ -43,8 +43,12 @@ const HierarchicalQP& VelocitySceneQP::update(){
     // check problem size
     size_t total_eqs = 0, total_ineqs = 0;
     bool has_bounds = false;
-    for(auto constraint : constraints[prio]) {
+    TimingStats::Clock::time_point start;
+    for(uint i = 0; i < constraints[prio].size(); i++) {
+        ConstraintPtr constraint = constraints[prio][i];
+        start = TimingStats::Clock::now();
         constraint->update(robot_model);
+        constraintTiming(prio,i).add(start);
         if(constraint->type() == Constraint::equality)
             total_eqs += constraint->size();
         else if(constraint->type() == Constraint::inequality)
@@ -58,7 +62,7 @@ const HierarchicalQP& VelocitySceneQP::update(){
     // QP Size: (ncp*6 x nj)
     // Variable order: (qd)
     QuadraticProgram &qp = hqp[prio];
-    qp.resize(nj, total_eqs, total_ineqs, has_bounds);
+    qp.resize(nj, total_eqs, total_ineqs, has_bounds, solver->constraintStaging());
     qp.lower_y.setConstant(-99999);
     qp.upper_y.setConstant(+99999);
     qp.lower_x.setConstant(-99999);
@@ -75,27 +79,29 @@ const HierarchicalQP& VelocitySceneQP::update(){
             qp.upper_x = constraints[prio][i]->ub();
         }
         else if (type == Constraint::equality) {
-            qp.A.middleRows(total_eqs, c_size) = constraints[prio][i]->A();
-            qp.b.segment(total_eqs, c_size) = constraints[prio][i]->b();
+            qp.setEqualityConstraints(total_eqs, constraints[prio][i]->A(), constraints[prio][i]->b());
             total_eqs += c_size;
         }
         else if (type == Constraint::inequality) {
-            qp.C.middleRows(total_ineqs, c_size) = constraints[prio][i]->A();
-            qp.lower_y.segment(total_ineqs, c_size) = constraints[prio][i]->lb();
-            qp.upper_y.segment(total_ineqs, c_size) = constraints[prio][i]->ub();
+            qp.setInequalityConstraints(total_ineqs, constraints[prio][i]->A(), constraints[prio][i]->lb(), constraints[prio][i]->ub());
             total_ineqs += c_size;
         }
     }
 
     ///////// Tasks    
+    double t_hessian = 0;
+    start = TimingStats::Clock::now();
     qp.H.setZero();
     qp.g.setZero();
+    t_hessian += TimingStats::elapsed(start);
     for(uint i = 0; i < tasks[prio].size(); i++){
         
         TaskPtr task = tasks[prio][i];
 
+        start = TimingStats::Clock::now();
         task->checkTimeout();
         task->update(robot_model);
+        taskTiming(prio,i).add(start);
 
         // If the activation value is zero, also set reference to zero. Activation is usually used to switch between different
         // task phases and we don't want to store the "old" reference value, in case we switch on the task again
@@ -104,20 +110,20 @@ const HierarchicalQP& VelocitySceneQP::update(){
            task->y_ref_root.setZero();
         }
 
-        for(int i = 0; i < task->A.rows(); i++)
-            task->Aw.row(i) = task->weights_root(i) * task->A.row(i) * task->activation * (!task->timeout);
-        for(int i = 0; i < task->A.cols(); i++)
-            task->Aw.col(i) = joint_weights[i] * task->Aw.col(i);
+        start = TimingStats::Clock::now();
+        weightTask(*task);
 
-        qp.H.block(0,0,nj,nj) += task->Aw.transpose()*task->Aw;
-        qp.g.segment(0,nj) -= task->Aw.transpose()*task->y_ref_root;
+        addTaskToCost(*task, qp.H.block(0,0,nj,nj), qp.g.segment(0,nj));
+        t_hessian += TimingStats::elapsed(start);
 
     } // tasks on prio
 
     // Add regularization term
+    start = TimingStats::Clock::now();
     qp.H.block(0,0,nj,nj).diagonal().array() += hessian_regularizer;
+    timing_stats[timing_hessian_assembly].add(t_hessian + TimingStats::elapsed(start));
 
-    hqp.Wq = base::VectorXd::Map(joint_weights.elements.data(), robot_model->noOfJoints());
+    hqp.Wq = joint_weights_vector;
     hqp.time = base::Time::now(); //  TODO: Use latest time stamp from all tasks!?
 
     return hqp;
@@ -3,6 +3,7 @@
 #include <base/Eigen.hpp>
 #include <Eigen/Core>
 #include <iostream>
+#include <limits>
 
 namespace wbc {
 
@@ -11,6 +12,21 @@ QPSolverRegistry<EiquadprogSolver> EiquadprogSolver::reg("eiquadprog");
 EiquadprogSolver::EiquadprogSolver()
 {
     _n_iter = 100;
+    _infinity = 1e10;
+    _n_ci_lower = 0;
+    _hessian_reuse = false;
+    _hessian_tolerance = 0;
+    _refactorization_cadence = 0;
+    _chol_valid = false;
+    _n_cycles_since_factorization = 0;
+    _n_factorizations = 0;
+    _c1 = 0;
+}
+
+void EiquadprogSolver::setHessianTolerance(double tol){
+    if(tol < 0)
+        throw std::invalid_argument("EiquadprogSolver: Hessian tolerance has to be >= 0");
+    _hessian_tolerance = tol;
 }
 
 EiquadprogSolver::~EiquadprogSolver()
@@ -18,8 +34,31 @@ EiquadprogSolver::~EiquadprogSolver()
 
 }
 
+void EiquadprogSolver::updateLayout(int nin, size_t n_var, size_t n_eq){
+
+    // First the lower sides, then the upper sides, each ordered as [C; I]
+    _ci_rows.clear();
+    for(size_t i = 0; i < _lower_finite.size(); i++)
+        if(_lower_finite[i])
+            _ci_rows.push_back(i);
+    _n_ci_lower = _ci_rows.size();
+    for(size_t i = 0; i < _upper_finite.size(); i++)
+        if(_upper_finite[i])
+            _ci_rows.push_back(i);
+
+    _CI_mtx.setZero(_ci_rows.size(), n_var);
+    _ci0_vec.setZero(_ci_rows.size());
+    for(size_t r = 0; r < _ci_rows.size(); r++)
+        if(_ci_rows[r] >= nin)
+            _CI_mtx(r, _ci_rows[r] - nin) = r < _n_ci_lower ? 1.0 : -1.0;   // map bounds as inequalities
+
+    _solver.reset(n_var, n_eq, _ci_rows.size());
+    _solver.setMaxIter(_n_iter);
+}
+
 void EiquadprogSolver::solve(const wbc::HierarchicalQP& hierarchical_qp, base::VectorXd& solver_output)
 {
+    SolveTimer timer(stats);
 
     if(hierarchical_qp.size() != 1)
         throw std::runtime_error("EiquadprogSolver::solve: Constraints vector size must be 1 for the current implementation");
@@ -27,51 +66,138 @@ void EiquadprogSolver::solve(const wbc::HierarchicalQP& hierarchical_qp, base::V
     const wbc::QuadraticProgram &qp = hierarchical_qp[0];
     qp.check();
 
-    size_t n_in = (qp.bounded ? (2 * (qp.nin + qp.nq)) : (2*qp.nin));
     size_t n_eq = qp.neq;
     size_t n_var = qp.nq;
+    size_t n_bounds = qp.bounded ? n_var : 0;
 
+    bool layout_changed = false;
     if(!configured) 
     {
-        _solver.reset(n_var, n_eq, n_in);
-        _solver.setMaxIter(_n_iter);
-
         // hessian and gradient are ok (don#t need to be stacked)
         // equality contraint is ok also
-        // configuring  inequalities constraints matrices
-        _CI_mtx.resize(n_in, n_var);
-        _ci0_vec.resize(n_in);
+        _n_var_init = n_var;
+        _n_eq_init = n_eq;
+        _n_in_init = qp.nin;
+        _bounded_init = qp.bounded;
+        layout_changed = true;
+        _chol_valid = false;
 
         configured = true;
     }
     else 
     {
-        if(n_var != _CI_mtx.cols())
-            throw std::runtime_error("QP problem changed dynamically. Not supported at the moment.");
-        if(n_in != _CI_mtx.rows())
+        if(n_var != _n_var_init || n_eq != _n_eq_init || (size_t)qp.nin != _n_in_init || qp.bounded != _bounded_init)
             throw std::runtime_error("QP problem changed dynamically. Not supported at the moment.");
     }
 
-    _CI_mtx.setZero();
-
-    // create inequalities constraint matric (inequalities + bounds)
-    _CI_mtx.middleRows(0, qp.nin) = qp.C;
-    _CI_mtx.middleRows(qp.nin, qp.nin) = -qp.C;
-    if(qp.bounded) {
-        _CI_mtx.middleRows(2*qp.nin, n_var).diagonal().setConstant(1.0);        // map bounds as inequalities
-        _CI_mtx.middleRows(2*qp.nin+n_var, n_var).diagonal().setConstant(-1.0);
+    // Only the finite sides of the inequality constraints and bounds are mapped to one-sided inequalities CI*x + ci0 >= 0.
+    // The row layout of CI only changes if a bound switches between finite and infinite
+    _lower_finite.resize(qp.nin + n_bounds);
+    _upper_finite.resize(qp.nin + n_bounds);
+    for(size_t i = 0; i < qp.nin + n_bounds; i++){
+        const double lower = i < (size_t)qp.nin ? qp.lower_y[i] : qp.lower_x[i-qp.nin];
+        const double upper = i < (size_t)qp.nin ? qp.upper_y[i] : qp.upper_x[i-qp.nin];
+        const bool lower_finite = lower > -_infinity;
+        const bool upper_finite = upper < _infinity;
+        layout_changed |= (lower_finite != _lower_finite[i]) || (upper_finite != _upper_finite[i]);
+        _lower_finite[i] = lower_finite;
+        _upper_finite[i] = upper_finite;
+    }
+    if(layout_changed)
+        updateLayout(qp.nin, n_var, n_eq);
+
+    // Only the rows of the inequality constraints are refilled, the rows of the bounds are constant
+    for(size_t r = 0; r < _ci_rows.size(); r++){
+        const int i = _ci_rows[r];
+        const bool upper = r >= _n_ci_lower;
+        if(i < qp.nin){
+            if(upper){
+                _CI_mtx.row(r) = -qp.C.row(i);
+                _ci0_vec[r] = qp.upper_y[i];
+            }
+            else{
+                _CI_mtx.row(r) = qp.C.row(i);
+                _ci0_vec[r] = -qp.lower_y[i];
+            }
+        }
+        else
+            _ci0_vec[r] = upper ? qp.upper_x[i-qp.nin] : -qp.lower_x[i-qp.nin];
     }
-    _ci0_vec << -qp.lower_y, qp.upper_y, -qp.lower_x, qp.upper_x;
 
     namespace eq = eiquadprog::solvers;
 
     Eigen::VectorXd out(qp.nq);
+    if(_hessian_reuse)
+    {
+        // Refactorize the Hessian only if it changed by more than the tolerance or if the refactorization cadence is reached
+        if(!_chol_valid || (_refactorization_cadence > 0 && _n_cycles_since_factorization >= _refactorization_cadence) ||
+           (qp.H - _H_factorized).cwiseAbs().maxCoeff() > _hessian_tolerance)
+        {
+            _H_factorized = qp.H;
+            _chol.compute(_H_factorized);
+            if(_chol.info() != Eigen::Success){
+                _chol_valid = false;
+                qp.print();
+                throw std::runtime_error("EiquadprogSolver: Cholesky decomposition of the Hessian failed. Hessian has to be positive definite.");
+            }
+            _c1 = _H_factorized.trace();
+            _chol_valid = true;
+            _n_cycles_since_factorization = 0;
+            _n_factorizations++;
+        }
+        _n_cycles_since_factorization++;
+
+        // This API expects the constraints column-wise: CE^T x + ce0 = 0, CI^T x + ci0 >= 0
+        _g0_vec = qp.g;
+        _CE_mtx_T = qp.A.transpose();
+        _ce0_vec = -qp.b;
+        _CI_mtx_T = _CI_mtx.transpose();
+        _active_set.resize(n_eq + _ci_rows.size());
+        size_t active_set_size;
+        double f = eq::solve_quadprog(_chol, _c1, _g0_vec, _CE_mtx_T, _ce0_vec, _CI_mtx_T, _ci0_vec, out, _active_set, active_set_size);
+
+        solver_output.resize(qp.nq);
+        solver_output = out;
+
+        _actual_n_iter = -1;
+        stats.status = (f == std::numeric_limits<double>::infinity() ? eq::EIQUADPROG_FAST_INFEASIBLE : eq::EIQUADPROG_FAST_OPTIMAL);
+        stats.n_active = (int)active_set_size - (int)n_eq;
+        stats.primal_residual = qp.primalResidual(solver_output);
+
+        if(f == std::numeric_limits<double>::infinity()){
+            qp.print();
+            throw std::runtime_error("Eiquadprog returned error status: infeasible.");
+        }
+        last_solution = solver_output;
+        return;
+    }
+
+    // Limit the number of iterations according to the time budget
+    const int max_iter = budgetedMaxIter(_n_iter);
+    _solver.setMaxIter(max_iter);
     eq::EiquadprogFast_status status = _solver.solve_quadprog(
         qp.H, qp.g, qp.A, -qp.b, _CI_mtx, _ci0_vec, out);
     
     solver_output.resize(qp.nq);
     solver_output = out;
 
+    _actual_n_iter = _solver.getIteratios();
+    stats.status = status;
+    stats.n_iter = _actual_n_iter;
+    stats.n_active = (int)_solver.getActiveSetSize() - (int)n_eq;
+    stats.primal_residual = qp.primalResidual(solver_output);
+    updateTimePerIteration(timer.elapsed(), _actual_n_iter);
+
+    // If the iterations have been limited due to the time budget, do not throw. The intermediate iterates of the dual active set method
+    // violate the inactive constraints, so return the last solution. Throw if there is none
+    if(status == eq::EiquadprogFast_status::EIQUADPROG_FAST_MAX_ITER_REACHED && max_iter < _n_iter){
+        stats.budget_exceeded = true;
+        if(last_solution.size() != qp.nq)
+            throw std::runtime_error("Eiquadprog returned error status: time budget exceeded and no feasible solution available.");
+        solver_output = last_solution;
+        return;
+    }
+
     if(status == eq::EiquadprogFast_status::EIQUADPROG_FAST_UNBOUNDED){
         qp.print();
         throw std::runtime_error("Eiquadprog returned error status:unbounded.");
@@ -88,7 +214,6 @@ void EiquadprogSolver::solve(const wbc::HierarchicalQP& hierarchical_qp, base::V
         qp.print();
         throw std::runtime_error("Eiquadprog returned error status: infeasible.");
     }
-
-    _actual_n_iter = _solver.getIteratios();
+    last_solution = solver_output;
 }
 }
@@ -4,8 +4,10 @@
 #include "../../core/QPSolver.hpp"
 
 #include <base/Time.hpp>
+#include <vector>
 
 #include <eiquadprog/eiquadprog-fast.hpp>
+#include <eiquadprog/eiquadprog.hpp>
 
 namespace wbc {
 
@@ -21,6 +23,12 @@ class HierarchicalQP;
  *             & \mathbf{CI}x + ci0 \geq 0& \\
  *        \end{array}
  *  \f]
+ *
+ * If Hessian reuse is enabled (see setHessianReuse()), the Cholesky factor of G is kept between calls to solve() and is only recomputed if G changes by
+ * more than the Hessian tolerance (max. absolute element-wise difference) or after a fixed number of cycles. This is useful if G is constant or changes
+ * slowly (e.g. constant task weights), so that only g0 and the constraints change in each cycle. In this mode, the solver uses the eiquadprog API
+ * with precomputed factorization, so that the maximum number of iterations and the time budget are not applied. Note that with a tolerance > 0, the problem is solved with
+ * the last factorized Hessian, i.e. the solution is approximate.
  */
 class EiquadprogSolver : public QPSolver{
 private:
@@ -44,17 +52,79 @@ public:
     /** Get the maximum number of working set recalculations to be performed during the initial homotopy*/
     uint getMaxNIter(){ return _n_iter; }
 
-    /** Get number of working set recalculations actually performed*/
+    /** Get number of working set recalculations actually performed. Returns -1 in Hessian reuse mode*/
     int getNter(){ return _actual_n_iter; }
 
+    /** Set the bound magnitude from which on the lower/upper side of an inequality constraint or bound is considered infinite. Infinite sides
+     *  are not passed to the solver. Default is 1e10*/
+    void setInfinity(double inf){ _infinity = inf; }
+
+    /** Get the bound magnitude from which on the lower/upper side of an inequality constraint or bound is considered infinite*/
+    double getInfinity(){ return _infinity; }
+
+    /** Enable/disable reuse of the Cholesky factorization of the Hessian between calls to solve(). Default is false*/
+    void setHessianReuse(bool reuse){ _hessian_reuse = reuse; _chol_valid = false; }
+
+    /** Return true if the Cholesky factorization of the Hessian is reused between calls to solve()*/
+    bool getHessianReuse(){ return _hessian_reuse; }
+
+    /** Set the max. absolute element-wise change of the Hessian since the last factorization, above which the Hessian is refactorized. Has to be >= 0. Default is 0,
+     *  i.e. the factorization is only reused if the Hessian is exactly the same*/
+    void setHessianTolerance(double tol);
+
+    /** Get the Hessian tolerance*/
+    double getHessianTolerance(){ return _hessian_tolerance; }
+
+    /** Refactorize the Hessian at least every n calls to solve(), independent of the Hessian tolerance. 0 means no fixed cadence. Default is 0*/
+    void setRefactorizationCadence(uint n){ _refactorization_cadence = n; }
+
+    /** Get the refactorization cadence*/
+    uint getRefactorizationCadence(){ return _refactorization_cadence; }
+
+    /** Get the number of Hessian factorizations performed in Hessian reuse mode since the solver was configured*/
+    uint getNoFactorizations(){ return _n_factorizations; }
+
+    /** Get the number of one-sided inequality constraints passed to the solver in the last call to solve()*/
+    size_t getNoInequalities(){ return _ci_rows.size(); }
+
 protected:
+    /** Recompute the row layout of CI from the finite sides and reset the solver. The bound rows are set here, since they are constant*/
+    void updateLayout(int nin, size_t n_var, size_t n_eq);
+
     eiquadprog::solvers::EiquadprogFast _solver;
     
     int _n_iter;
     int _actual_n_iter;
 
+    double _infinity;
+
+    size_t _n_var_init; // number of variables in the configured solver instance
+    size_t _n_eq_init;  // number of equalities in the configured solver instance
+    size_t _n_in_init;  // number of two-sided inequalities in the configured solver instance (excluding bounds)
+    bool _bounded_init; // whether the configured solver instance has bounds on the variables
+
+    std::vector<bool> _lower_finite; // finite lower sides of [inequalities; bounds]
+    std::vector<bool> _upper_finite; // finite upper sides of [inequalities; bounds]
+    std::vector<int> _ci_rows;       // index in [inequalities; bounds] of each row of CI
+    size_t _n_ci_lower;              // number of rows of CI that map a lower side, these come first
+
     Eigen::MatrixXd _CI_mtx;
     Eigen::VectorXd _ci0_vec;
+
+    bool _hessian_reuse;
+    double _hessian_tolerance;
+    uint _refactorization_cadence;
+    bool _chol_valid;                           // true if _chol contains a valid factorization of _H_factorized
+    uint _n_cycles_since_factorization;
+    uint _n_factorizations;
+    Eigen::MatrixXd _H_factorized;              // Hessian at the last factorization
+    Eigen::LLT<Eigen::MatrixXd,Eigen::Lower> _chol;
+    double _c1;                                 // trace of _H_factorized
+    Eigen::VectorXd _g0_vec;
+    Eigen::MatrixXd _CE_mtx_T;                  // transposed equality constraint matrix
+    Eigen::VectorXd _ce0_vec;
+    Eigen::MatrixXd _CI_mtx_T;                  // transposed inequality constraint matrix
+    Eigen::VectorXi _active_set;
 };
 
 }
@@ -209,3 +209,106 @@ BOOST_AUTO_TEST_CASE(solver_eiquadprog_bounded)
         BOOST_CHECK((qp.lower_x(j)-1e-9) <= solver_output(j) && solver_output(j) <= (qp.upper_x(j)+1e-9));
 
 }
+
+BOOST_AUTO_TEST_CASE(solver_eiquadprog_one_sided_constraints)
+{
+    const int NO_JOINTS = 4;
+    const int NO_EQ_CONSTRAINTS = 0;
+    const int NO_IN_CONSTRAINTS = 2;
+    const bool WITH_BOUNDS = true;
+
+    // Solve the problem min(||x-x_ref||) with inequality constraints and bounds, where some sides are infinite (+-1e10).
+    // Only the finite sides must be passed to the solver
+
+    wbc::QuadraticProgram qp;
+    qp.resize(NO_JOINTS, NO_EQ_CONSTRAINTS, NO_IN_CONSTRAINTS, WITH_BOUNDS);
+
+    base::VectorXd x_ref(NO_JOINTS);
+    x_ref << 1.0, -1.0, 0.5, -0.5;
+
+    qp.H.setIdentity();
+    qp.g = -x_ref;
+    qp.C << 1, 0, 0, 0,
+            0, 1, 0, 0;
+    qp.lower_y << -1e10, -0.2;
+    qp.upper_y << 0.3, 1e10;
+    qp.lower_x << -1e10, -1e10, -1e10, -0.1;
+    qp.upper_x << 1e10, 1e10, 0.4, 1e10;
+
+    qp.check();
+    wbc::HierarchicalQP hqp;
+    hqp << qp;
+
+    EiquadprogSolver solver;
+    base::VectorXd solver_output;
+    BOOST_CHECK_NO_THROW(solver.solve(hqp, solver_output));
+    BOOST_CHECK(solver.getNoInequalities() == 4);
+
+    base::VectorXd expected(NO_JOINTS);
+    expected << 0.3, -0.2, 0.4, -0.1;
+    for(uint j = 0; j < NO_JOINTS; ++j)
+        BOOST_CHECK(fabs(solver_output(j) - expected(j)) < 1e-9);
+
+    // A side becoming finite changes the number of inequality constraints
+    hqp[0].upper_x[0] = 0.2;
+    BOOST_CHECK_NO_THROW(solver.solve(hqp, solver_output));
+    BOOST_CHECK(solver.getNoInequalities() == 5);
+    BOOST_CHECK(fabs(solver_output(0) - 0.2) < 1e-9);
+}
+
+BOOST_AUTO_TEST_CASE(solver_eiquadprog_hessian_reuse)
+{
+    const int NO_JOINTS = 4;
+    const int NO_EQ_CONSTRAINTS = 1;
+    const int NO_IN_CONSTRAINTS = 0;
+    const bool WITH_BOUNDS = true;
+
+    // Solve the problem min(||x-x_ref||), subject to x_0 + x_1 = 1 and bounds, where only x_ref changes between the calls.
+    // The factorization of the Hessian has to be reused
+
+    wbc::QuadraticProgram qp;
+    qp.resize(NO_JOINTS, NO_EQ_CONSTRAINTS, NO_IN_CONSTRAINTS, WITH_BOUNDS);
+    qp.H.setIdentity();
+    qp.A << 1, 1, 0, 0;
+    qp.b << 1;
+    qp.lower_x.setConstant(-0.5);
+    qp.upper_x.setConstant(0.5);
+
+    wbc::HierarchicalQP hqp;
+    hqp << qp;
+
+    EiquadprogSolver solver;
+    solver.setHessianReuse(true);
+    BOOST_CHECK(solver.getHessianReuse());
+    BOOST_CHECK_THROW(solver.setHessianTolerance(-1), std::invalid_argument);
+
+    base::VectorXd solver_output, x_ref(NO_JOINTS), expected(NO_JOINTS);
+    for(int i = 0; i < 3; i++){
+        x_ref << 0.2*i, 0, 0.2*i, -1;
+        hqp[0].g = -x_ref;
+        BOOST_CHECK_NO_THROW(solver.solve(hqp, solver_output));
+        // x_0 + x_1 = 1 with |x_0|,|x_1| <= 0.5 has the unique solution x_0 = x_1 = 0.5, x_3 is at its lower bound
+        expected << 0.5, 0.5, 0.2*i, -0.5;
+        for(uint j = 0; j < NO_JOINTS; ++j)
+            BOOST_CHECK(fabs(solver_output(j) - expected(j)) < 1e-9);
+    }
+    BOOST_CHECK(solver.getNoFactorizations() == 1);
+
+    // Hessian changes less than the tolerance: No refactorization
+    solver.setHessianTolerance(1e-3);
+    hqp[0].H(2,2) = 1 + 1e-4;
+    BOOST_CHECK_NO_THROW(solver.solve(hqp, solver_output));
+    BOOST_CHECK(solver.getNoFactorizations() == 1);
+
+    // Hessian changes more than the tolerance: Refactorization
+    hqp[0].H(2,2) = 2;
+    BOOST_CHECK_NO_THROW(solver.solve(hqp, solver_output));
+    BOOST_CHECK(solver.getNoFactorizations() == 2);
+    BOOST_CHECK(fabs(solver_output(2) - 0.2) < 1e-9);
+
+    // Fixed refactorization cadence
+    solver.setRefactorizationCadence(2);
+    for(int i = 0; i < 4; i++)
+        BOOST_CHECK_NO_THROW(solver.solve(hqp, solver_output));
+    BOOST_CHECK(solver.getNoFactorizations() == 4);
+}
@@ -0,0 +1,111 @@
+#include "FallbackSolver.hpp"
+#include "../../core/QuadraticProgram.hpp"
+#include <stdexcept>
+
+namespace wbc{
+
+QPSolverRegistry<FallbackSolver> FallbackSolver::reg("fallback");
+
+FallbackSolver::FallbackSolver() :
+    use_last_solution(true),
+    active_stage(-1){
+}
+
+FallbackSolver::~FallbackSolver(){
+}
+
+void FallbackSolver::setSolvers(const std::vector<QPSolverPtr>& solvers){
+    if(solvers.empty())
+        throw std::invalid_argument("FallbackSolver: List of solvers must not be empty");
+    for(const QPSolverPtr& solver : solvers){
+        if(!solver)
+            throw std::invalid_argument("FallbackSolver: Solver is a null pointer");
+    }
+    stages = solvers;
+    stage_counts.assign(stages.size() + 1, 0);
+    stage_errors.assign(stages.size(), "");
+    active_stage = -1;
+    configured = false;
+}
+
+void FallbackSolver::setSolvers(const std::vector<std::string>& solver_names){
+    std::vector<QPSolverPtr> solvers;
+    for(const std::string& name : solver_names){
+        if(name == "fallback")
+            throw std::invalid_argument("FallbackSolver: Solver stages must not be of type fallback");
+        solvers.push_back(QPSolverPtr(QPSolverFactory::createInstance(name)));
+    }
+    setSolvers(solvers);
+}
+
+bool FallbackSolver::constraintStaging() const{
+    if(stages.empty())
+        return false;
+    for(const QPSolverPtr& stage : stages){
+        if(!stage->constraintStaging())
+            return false;
+    }
+    return true;
+}
+
+void FallbackSolver::solve(const wbc::HierarchicalQP &hierarchical_qp, base::VectorXd &solver_output){
+
+    SolveTimer timer(stats);
+
+    if(stages.empty())
+        throw std::runtime_error("FallbackSolver: No solvers have been set. Call setSolvers() first");
+
+    // Enforce reconfiguration of all stages, e.g. after reset()
+    if(!configured){
+        for(const QPSolverPtr& stage : stages)
+            stage->reset();
+        last_solution.resize(0);
+        configured = true;
+    }
+
+    active_stage = -1;
+    for(size_t i = 0; i < stages.size(); i++){
+        stage_errors[i].clear();
+        const double remaining_time = time_budget - timer.elapsed();
+        if(time_budget > 0 && remaining_time <= 0){
+            stats.budget_exceeded = true;
+            stage_errors[i] = "Time budget exceeded";
+            break;
+        }
+        // Always propagate the budget, so that disabling it (0) also takes effect in the stages
+        stages[i]->setTimeBudget(time_budget > 0 ? remaining_time : 0);
+        try{
+            stages[i]->solve(hierarchical_qp, solver_output);
+        }
+        catch(std::exception& e){
+            // Enforce reconfiguration of the failed stage in the next call, since its internal state (e.g. warm start) may be invalid
+            stage_errors[i] = e.what();
+            stages[i]->reset();
+            continue;
+        }
+        active_stage = i;
+        break;
+    }
+
+    if(active_stage >= 0){
+        const bool budget_exceeded = stats.budget_exceeded;
+        stats = stages[active_stage]->getStats();
+        stats.budget_exceeded |= budget_exceeded;
+        if(!stats.budget_exceeded)
+            last_solution = solver_output;
+    }
+    else{
+        // All stages failed: Use the last valid solution, if it matches the current problem size
+        if(!use_last_solution || last_solution.size() == 0 || hierarchical_qp.size() == 0 || last_solution.size() != hierarchical_qp[0].nq){
+            std::string msg = "FallbackSolver: All solvers failed.";
+            for(size_t i = 0; i < stages.size(); i++)
+                msg += " Stage " + std::to_string(i) + ": " + (stage_errors[i].empty() ? "not tried" : stage_errors[i]) + ".";
+            throw std::runtime_error(msg);
+        }
+        solver_output = last_solution;
+        active_stage = stages.size();
+    }
+    stage_counts[active_stage]++;
+}
+
+}
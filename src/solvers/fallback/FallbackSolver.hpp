@@ -0,0 +1,66 @@
+#ifndef WBC_SOLVERS_FALLBACK_SOLVER_HPP
+#define WBC_SOLVERS_FALLBACK_SOLVER_HPP
+
+#include "../../core/QPSolver.hpp"
+#include <string>
+#include <vector>
+
+namespace wbc {
+
+class HierarchicalQP;
+
+/**
+ * @brief The FallbackSolver is a composite solver that wraps an ordered list of solvers (stages), e.g. a fast solver followed by a reliable one.
+ * In each call to solve(), the stages are tried in order until one of them succeeds, i.e. does not throw. A failed stage is reset, so that it is
+ * reconfigured (e.g. cold started) in the next call. If all stages fail, the last valid solution is returned (see setUseLastSolution()) or an
+ * exception is thrown. The stage that produced the result is recorded (see getActiveStage()).
+ *
+ * If a time budget is set (see QPSolver::setTimeBudget()), each stage gets the time that is remaining in the current call. Stages are skipped
+ * once the budget is exhausted. Without a time budget, the budget of all stages is disabled as well.
+ */
+class FallbackSolver : public QPSolver{
+private:
+    static QPSolverRegistry<FallbackSolver> reg;
+
+public:
+    FallbackSolver();
+    virtual ~FallbackSolver();
+
+    /**
+     * @brief solve Solve the given quadratic program with the first stage that succeeds
+     * @param hierarchical_qp Description of the hierarchical quadratic program to solve
+     * @param solver_output solution of the quadratic program
+     */
+    virtual void solve(const wbc::HierarchicalQP &hierarchical_qp, base::VectorXd &solver_output);
+
+    /** Set the solver stages in the order in which they are tried. Must not be empty*/
+    void setSolvers(const std::vector<QPSolverPtr>& solvers);
+    /** Create the solver stages from the given registered solver names (see QPSolverFactory), in the order in which they are tried. Must not be empty*/
+    void setSolvers(const std::vector<std::string>& solver_names);
+    /** The QP is only staged (see QPSolver::constraintStaging()) if all stages read the constraints from the staging buffer*/
+    virtual bool constraintStaging() const;
+    /** Get the solver stages*/
+    const std::vector<QPSolverPtr>& getSolvers(){return stages;}
+    /** If true (default), the last valid solution is returned if all stages fail. It is not returned if the problem size has changed*/
+    void setUseLastSolution(bool use){use_last_solution = use;}
+    /** Return true if the last valid solution is used if all stages fail*/
+    bool getUseLastSolution(){return use_last_solution;}
+    /** Index of the stage that produced the result of the last call to solve(). Equal to the number of stages if the last valid solution has
+     *  been returned, -1 if solve() failed or has not been called yet*/
+    int getActiveStage(){return active_stage;}
+    /** Number of calls to solve() in which each stage produced the result. The last entry counts the calls in which the last valid solution has been returned*/
+    const std::vector<uint>& getStageCounts(){return stage_counts;}
+    /** Error messages of the stages that failed in the last call to solve(). Empty strings for stages that succeeded or were not tried*/
+    const std::vector<std::string>& getStageErrors(){return stage_errors;}
+
+protected:
+    std::vector<QPSolverPtr> stages;
+    std::vector<uint> stage_counts;
+    std::vector<std::string> stage_errors;
+    bool use_last_solution;
+    int active_stage;
+};
+
+}
+
+#endif
@@ -0,0 +1,143 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+#include "core/QuadraticProgram.hpp"
+#include "solvers/fallback/FallbackSolver.hpp"
+#include "solvers/hls/HierarchicalLSSolver.hpp"
+
+using namespace wbc;
+using namespace std;
+
+/** Dummy solver that returns a constant solution or throws, depending on the fail flag*/
+class DummySolver : public QPSolver{
+public:
+    DummySolver(double value) : fail(false), staging(false), value(value){}
+    virtual bool constraintStaging() const {return staging;}
+    virtual void solve(const HierarchicalQP& hierarchical_qp, base::VectorXd &solver_output){
+        SolveTimer timer(stats);
+        if(fail)
+            throw std::runtime_error("DummySolver failed");
+        solver_output.setConstant(hierarchical_qp[0].nq, value);
+        stats.status = 0;
+    }
+    bool fail;
+    bool staging;
+    double value;
+};
+
+HierarchicalQP makeProblem(){
+    // Solve the problem A*x = b with the hls solver
+    QuadraticProgram qp;
+    qp.resize(6, 6, 0, false);
+    qp.A << 0.642, 0.706, 0.565,  0.48,  0.59, 0.917,
+            0.553, 0.087,  0.43,  0.71, 0.148,  0.87,
+            0.249, 0.632, 0.711,  0.13, 0.426, 0.963,
+            0.682, 0.123, 0.998, 0.716, 0.961, 0.901,
+            0.891, 0.019, 0.716, 0.534, 0.725, 0.633,
+            0.315, 0.551, 0.462, 0.221, 0.638, 0.244;
+    qp.b << 0.833, 0.096, 0.078, 0.971, 0.883, 0.366;
+    HierarchicalQP hqp;
+    hqp.Wq.setOnes(6);
+    hqp << qp;
+    return hqp;
+}
+
+BOOST_AUTO_TEST_CASE(solver_fallback_stages)
+{
+    HierarchicalQP hqp = makeProblem();
+
+    FallbackSolver solver;
+    base::VectorXd solver_output;
+    BOOST_CHECK_THROW(solver.solve(hqp, solver_output), std::runtime_error);
+    BOOST_CHECK_THROW(solver.setSolvers(std::vector<QPSolverPtr>()), std::invalid_argument);
+
+    std::shared_ptr<DummySolver> fast = std::make_shared<DummySolver>(1.0);
+    solver.setSolvers({fast, std::make_shared<HierarchicalLSSolver>()});
+    BOOST_CHECK(solver.getActiveStage() == -1);
+
+    // First stage succeeds
+    BOOST_CHECK_NO_THROW(solver.solve(hqp, solver_output));
+    BOOST_CHECK(solver.getActiveStage() == 0);
+    for(int j = 0; j < 6; j++)
+        BOOST_CHECK(solver_output[j] == 1.0);
+
+    // First stage fails: Fall back to the hls solver in the same call
+    fast->fail = true;
+    BOOST_CHECK_NO_THROW(solver.solve(hqp, solver_output));
+    BOOST_CHECK(solver.getActiveStage() == 1);
+    BOOST_CHECK(solver.getStageErrors()[0] == "DummySolver failed");
+    BOOST_CHECK(solver.getStageErrors()[1].empty());
+    HierarchicalLSSolver reference_solver;
+    base::VectorXd reference;
+    reference_solver.solve(hqp, reference);
+    for(int j = 0; j < 6; j++)
+        BOOST_CHECK(fabs(solver_output[j] - reference[j]) < 1e-12);
+    BOOST_CHECK(solver.getStats().status == 0);
+    BOOST_CHECK(solver.getStats().solve_time > 0);
+
+    BOOST_CHECK(solver.getStageCounts().size() == 3);
+    BOOST_CHECK(solver.getStageCounts()[0] == 1);
+    BOOST_CHECK(solver.getStageCounts()[1] == 1);
+    BOOST_CHECK(solver.getStageCounts()[2] == 0);
+
+    // Constraint staging is only used if all stages support it
+    BOOST_CHECK(!solver.constraintStaging());
+    std::shared_ptr<DummySolver> staged_0 = std::make_shared<DummySolver>(1.0), staged_1 = std::make_shared<DummySolver>(2.0);
+    staged_0->staging = staged_1->staging = true;
+    FallbackSolver staged_solver;
+    BOOST_CHECK(!staged_solver.constraintStaging());
+    staged_solver.setSolvers({staged_0, staged_1});
+    BOOST_CHECK(staged_solver.constraintStaging());
+    staged_1->staging = false;
+    BOOST_CHECK(!staged_solver.constraintStaging());
+
+    // The time budget is propagated to the stages, also when it is disabled again
+    solver.setTimeBudget(1.0);
+    BOOST_CHECK_NO_THROW(solver.solve(hqp, solver_output));
+    BOOST_CHECK(fast->getTimeBudget() > 0 && fast->getTimeBudget() <= 1.0);
+    solver.setTimeBudget(0);
+    BOOST_CHECK_NO_THROW(solver.solve(hqp, solver_output));
+    BOOST_CHECK(fast->getTimeBudget() == 0);
+    BOOST_CHECK(solver.getSolvers()[1]->getTimeBudget() == 0);
+}
+
+BOOST_AUTO_TEST_CASE(solver_fallback_last_solution)
+{
+    HierarchicalQP hqp = makeProblem();
+
+    std::shared_ptr<DummySolver> first = std::make_shared<DummySolver>(1.0);
+    std::shared_ptr<DummySolver> second = std::make_shared<DummySolver>(2.0);
+    FallbackSolver solver;
+    solver.setSolvers({first, second});
+
+    base::VectorXd solver_output;
+    BOOST_CHECK_NO_THROW(solver.solve(hqp, solver_output));
+
+    // All stages fail: Return the last valid solution
+    first->fail = second->fail = true;
+    solver_output.setZero();
+    BOOST_CHECK_NO_THROW(solver.solve(hqp, solver_output));
+    BOOST_CHECK(solver.getActiveStage() == 2);
+    BOOST_CHECK(solver.getStageCounts()[2] == 1);
+    for(int j = 0; j < 6; j++)
+        BOOST_CHECK(solver_output[j] == 1.0);
+
+    // All stages fail and the last solution must not be used
+    solver.setUseLastSolution(false);
+    BOOST_CHECK_THROW(solver.solve(hqp, solver_output), std::runtime_error);
+    BOOST_CHECK(solver.getActiveStage() == -1);
+}
+
+BOOST_AUTO_TEST_CASE(solver_fallback_factory)
+{
+    FallbackSolver* solver = QPSolverFactory::createInstance<FallbackSolver>("fallback");
+    BOOST_CHECK(solver != 0);
+    BOOST_CHECK_THROW(solver->setSolvers(std::vector<std::string>{"fallback"}), std::invalid_argument);
+    BOOST_CHECK_NO_THROW(solver->setSolvers(std::vector<std::string>{"hls"}));
+
+    HierarchicalQP hqp = makeProblem();
+    base::VectorXd solver_output;
+    BOOST_CHECK_NO_THROW(solver->solve(hqp, solver_output));
+    BOOST_CHECK(solver->getActiveStage() == 0);
+    delete solver;
+}
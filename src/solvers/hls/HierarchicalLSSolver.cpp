@@ -1,5 +1,6 @@
 #include "HierarchicalLSSolver.hpp"
 #include <stdexcept>
+#include <limits>
 #include <tools/SVD.hpp>
 #include "../../core/QuadraticProgram.hpp"
 
@@ -9,10 +10,23 @@ namespace wbc{
 
 QPSolverRegistry<HierarchicalLSSolver> HierarchicalLSSolver::reg("hls");
 
+/** Copy the thin SVD computed by Eigen into the full size matrices that are expected by the solver, i.e. U: nc x nj, s_vals: nj x 1, V: nj x nj.
+ *  Singular values and singular vectors that are not computed by the thin SVD are set to zero*/
+template<typename SVD> void copySVD(const SVD& svd, base::MatrixXd& U, base::VectorXd& s_vals, base::MatrixXd& V){
+    const int k = svd.singularValues().size();
+    U.leftCols(k) = svd.matrixU();
+    U.rightCols(U.cols() - k).setZero();
+    s_vals.head(k) = svd.singularValues();
+    s_vals.tail(s_vals.size() - k).setZero();
+    V.leftCols(k) = svd.matrixV();
+    V.rightCols(V.cols() - k).setZero();
+}
+
 HierarchicalLSSolver::HierarchicalLSSolver() :
     no_of_joints(0),
     min_eigenvalue(1e-9),
-    max_solver_output_norm(10){
+    max_solver_output_norm(10),
+    decomposition(hls_kdl_svd){
 }
 
 HierarchicalLSSolver::~HierarchicalLSSolver(){
@@ -42,8 +56,8 @@ bool HierarchicalLSSolver::configure(const std::vector<int>& n_constraints_per_p
     s_vals.setZero(no_of_joints);
     sing_vect_r.resize(no_of_joints, no_of_joints);
     sing_vect_r.setIdentity();
-    s_vals_inv.setZero(no_of_joints, no_of_joints);
-    damped_s_vals_inv.setZero(no_of_joints, no_of_joints);
+    s_vals_inv.setZero(no_of_joints);
+    damped_s_vals_inv.setZero(no_of_joints);
     Wq_V.setZero(no_of_joints, no_of_joints);
     Wq_V_s_vals_inv.setZero(no_of_joints, no_of_joints);
     Wq_V_damped_s_vals_inv.setZero(no_of_joints, no_of_joints);
@@ -55,6 +69,8 @@ bool HierarchicalLSSolver::configure(const std::vector<int>& n_constraints_per_p
 
 void HierarchicalLSSolver::solve(const wbc::HierarchicalQP &hierarchical_qp, base::VectorXd &solver_output){
 
+    SolveTimer timer(stats);
+
     if(!configured){
         uint n_joints;
         std::vector<int> n_constraints_per_prio;
@@ -97,83 +113,138 @@ void HierarchicalLSSolver::solve(const wbc::HierarchicalQP &hierarchical_qp, bas
         if(hierarchical_qp.Wq.size() != 0)
             setJointWeights(hierarchical_qp.Wq, prio);
 
-        priorities[prio].y_comp.setZero();
-
         // Compensate y for part of the solution already met in higher priorities. For the first priority y_comp will be equal to  y
-        priorities[prio].y_comp = hierarchical_qp[prio].b - hierarchical_qp[prio].A*solver_output;
+        priorities[prio].y_comp = hierarchical_qp[prio].b;
+        if(prio > 0)
+            priorities[prio].y_comp.noalias() -= hierarchical_qp[prio].A*solver_output;
 
         // projection of A on the null space of previous priorities: A_proj = A * P = A * ( P(p-1) - (A_wdls)^# * A )
         // For the first priority P == Identity
-        priorities[prio].A_proj = hierarchical_qp[prio].A * proj_mat;
+        if(prio == 0)
+            priorities[prio].A_proj = hierarchical_qp[prio].A;
+        else
+            priorities[prio].A_proj.noalias() = hierarchical_qp[prio].A * proj_mat;
 
         // Compute weighted, projected mat: A_proj_w = Wy * A_proj * Wq^-1
         // Since the weight matrices are diagonal, there is no need for full matrix multiplication
+        priorities[prio].A_proj_w.noalias() = priorities[prio].constraint_weights.asDiagonal() * priorities[prio].A_proj * priorities[prio].joint_weights.asDiagonal();
 
-        for(uint i = 0; i < priorities[prio].n_constraint_variables; i++)
-            priorities[prio].A_proj_w.row(i) = priorities[prio].constraint_weight_mat(i,i) * priorities[prio].A_proj.row(i);
-
-        for(uint i = 0; i < no_of_joints; i++)
-            priorities[prio].A_proj_w.col(i) = priorities[prio].joint_weight_mat(i,i) * priorities[prio].A_proj_w.col(i);
-
-        svd_eigen_decomposition(priorities[prio].A_proj_w, priorities[prio].U, s_vals, sing_vect_r, tmp);
-
-        // Compute damping factor based on
-        // A.A. Maciejewski, C.A. Klein, “Numerical Filtering for the Operation of
-        // Robotic Manipulators through Kinematically Singular Configurations”,
-        // Journal of Robotic Systems, Vol. 5, No. 6, pp. 527 - 552, 1988.
-        double s_min = s_vals.block(0,0,min(no_of_joints, priorities[prio].n_constraint_variables),1).minCoeff();
-        if(s_min <= (1/max_solver_output_norm)/2)
-            priorities[prio].damping = (1/max_solver_output_norm)/2;
-        else if(s_min >= (1/max_solver_output_norm))
-            priorities[prio].damping = 0;
-        else
-            priorities[prio].damping = sqrt(s_min*((1/max_solver_output_norm)-s_min));
-
-        // Damped Inverse of Eigenvalue matrix for computation of a singularity robust solution for the current priority
-        damped_s_vals_inv.setZero();
-        for (uint i = 0; i < min(no_of_joints, priorities[prio].n_constraint_variables); i++)
-            damped_s_vals_inv(i,i) = (s_vals(i) / (s_vals(i) * s_vals(i) + priorities[prio].damping * priorities[prio].damping));
-
-        // Additionally compute normal Inverse of Eigenvalue matrix for correct computation of nullspace projection
-        for(uint i = 0; i < s_vals.rows(); i++){
-            if(s_vals(i) < min_eigenvalue)
-                s_vals_inv(i,i) = 0;
-            else
-                s_vals_inv(i,i) = 1 / s_vals(i);
-        }
-
-        // A^# = Wq^-1 * V * S^# * U^T * Wy
-        // Since the weight matrices are diagonal, there is no need for full matrix multiplication (saves a lot of computation!)
-        priorities[prio].u_t_weight_mat = priorities[prio].U.transpose();
-        for(uint i = 0; i < priorities[prio].n_constraint_variables; i++)
-            priorities[prio].u_t_weight_mat.col(i) = priorities[prio].u_t_weight_mat.col(i) * priorities[prio].constraint_weight_mat(i,i);
+        const bool ldlt = decomposition == hls_ldlt && computeLDLTInverse(priorities[prio]);
+        if(!ldlt)
+            computeSVDInverse(priorities[prio]);
 
-        for(uint i = 0; i < no_of_joints; i++)
-            Wq_V.row(i) = priorities[prio].joint_weight_mat(i,i) * sing_vect_r.row(i);
+        // x = x + A^# * y
+        priorities[prio].solution_prio.noalias() = priorities[prio].A_proj_inv_wdls * priorities[prio].y_comp;
+        solver_output += priorities[prio].solution_prio;
 
-        for(uint i = 0; i < no_of_joints; i++)
-            Wq_V_s_vals_inv.col(i) = Wq_V.col(i) * s_vals_inv(i,i);
-        for(uint i = 0; i < no_of_joints; i++)
-            Wq_V_damped_s_vals_inv.col(i) = Wq_V.col(i) * damped_s_vals_inv(i,i);
+        // Compute projection matrix for the next priority (not required after the last priority). Use here the undamped inverse to have a correct solution.
+        // In case of SVD, A^# * A_proj = (Wq^-1 * V_r * S_r^-1) * (U_r^T * Wy * A_proj), where r is the numerical rank of A_proj_w, so that this can be
+        // computed as rank r update of the projection matrix
+        if(prio + 1 < priorities.size()){
+            PriorityData& p = priorities[prio];
+            if(ldlt)
+                proj_mat.noalias() -= p.A_proj_inv_wls * p.A_proj;
+            else{
+                p.u_t_weight_mat_A_proj.topRows(p.rank).noalias() = p.u_t_weight_mat.topRows(p.rank) * p.A_proj;
+                proj_mat.noalias() -= Wq_V_s_vals_inv.leftCols(p.rank) * p.u_t_weight_mat_A_proj.topRows(p.rank);
+            }
+        }
+    } //priority loop
 
-        priorities[prio].A_proj_inv_wls = Wq_V_s_vals_inv * priorities[prio].u_t_weight_mat; //Normal Inverse with weighting
-        priorities[prio].A_proj_inv_wdls = Wq_V_damped_s_vals_inv * priorities[prio].u_t_weight_mat; //Damped inverse with weighting
+    ///////////////
 
-        // x = x + A^# * y
-        priorities[prio].solution_prio = priorities[prio].A_proj_inv_wdls * priorities[prio].y_comp;
-        solver_output += priorities[prio].solution_prio;
+    // The solution is computed directly, so there are no iterations and no active set
+    stats.status = 0;
+    stats.primal_residual = hierarchical_qp[0].primalResidual(solver_output);
+}
 
-        // Compute projection matrix for the next priority. Use here the undamped inverse to have a correct solution
-        proj_mat -= priorities[prio].A_proj_inv_wls * priorities[prio].A_proj;
+void HierarchicalLSSolver::computeSVDInverse(PriorityData& prio_data){
+
+    switch(decomposition){
+    case hls_kdl_svd:
+        svd_eigen_decomposition(prio_data.A_proj_w, prio_data.U, s_vals, sing_vect_r, tmp);
+        break;
+    case hls_jacobi_svd:
+        prio_data.jacobi_svd.compute(prio_data.A_proj_w);
+        copySVD(prio_data.jacobi_svd, prio_data.U, s_vals, sing_vect_r);
+        break;
+    default:
+        prio_data.bdc_svd.compute(prio_data.A_proj_w);
+        copySVD(prio_data.bdc_svd, prio_data.U, s_vals, sing_vect_r);
+        break;
+    }
 
-        //store eigenvalues for this priority
-        priorities[prio].sing_vals.setZero();
-        for(uint i = 0; i < no_of_joints; i++)
-            priorities[prio].sing_vals(i) = s_vals(i);
+    // Compute damping factor based on
+    // A.A. Maciejewski, C.A. Klein, “Numerical Filtering for the Operation of
+    // Robotic Manipulators through Kinematically Singular Configurations”,
+    // Journal of Robotic Systems, Vol. 5, No. 6, pp. 527 - 552, 1988.
+    const uint k = min(no_of_joints, prio_data.n_constraint_variables);
+    double s_min = s_vals.head(k).minCoeff();
+    if(s_min <= (1/max_solver_output_norm)/2)
+        prio_data.damping = (1/max_solver_output_norm)/2;
+    else if(s_min >= (1/max_solver_output_norm))
+        prio_data.damping = 0;
+    else
+        prio_data.damping = sqrt(s_min*((1/max_solver_output_norm)-s_min));
+
+    // Damped inverse of the singular values for computation of a singularity robust solution for the current priority
+    damped_s_vals_inv.head(k) = s_vals.head(k).array() / (s_vals.head(k).array().square() + prio_data.damping * prio_data.damping);
+
+    // Additionally compute normal inverse of the singular values for correct computation of nullspace projection. The singular values are sorted
+    // in descending order, so that the numerical rank is the number of leading singular values >= min_eigenvalue
+    prio_data.rank = 0;
+    while(prio_data.rank < k && s_vals(prio_data.rank) >= min_eigenvalue)
+        prio_data.rank++;
+    s_vals_inv.head(k).setZero();
+    s_vals_inv.head(prio_data.rank) = s_vals.head(prio_data.rank).cwiseInverse();
+
+    // A^# = Wq^-1 * V * S^# * U^T * Wy
+    // Since the weight matrices and S^# are diagonal, there is no need for full matrix multiplication (saves a lot of computation!). Also, only the
+    // first k singular vectors contribute to the inverse
+    prio_data.u_t_weight_mat.topRows(k) = prio_data.U.leftCols(k).transpose() * prio_data.constraint_weights.asDiagonal();
+    Wq_V.leftCols(k) = prio_data.joint_weights.asDiagonal() * sing_vect_r.leftCols(k);
+    Wq_V_s_vals_inv.leftCols(k) = Wq_V.leftCols(k) * s_vals_inv.head(k).asDiagonal();
+    Wq_V_damped_s_vals_inv.leftCols(k) = Wq_V.leftCols(k) * damped_s_vals_inv.head(k).asDiagonal();
+
+    prio_data.A_proj_inv_wls.noalias() = Wq_V_s_vals_inv.leftCols(k) * prio_data.u_t_weight_mat.topRows(k); //Normal Inverse with weighting
+    prio_data.A_proj_inv_wdls.noalias() = Wq_V_damped_s_vals_inv.leftCols(k) * prio_data.u_t_weight_mat.topRows(k); //Damped inverse with weighting
+
+    //store singular values for this priority
+    prio_data.sing_vals = s_vals;
+}
 
-    } //priority loop
+bool HierarchicalLSSolver::computeLDLTInverse(PriorityData& prio_data){
+
+    // More constraints than joints: The Gram matrix is always singular
+    if(prio_data.n_constraint_variables > no_of_joints)
+        return false;
+
+    prio_data.gram.noalias() = prio_data.A_proj_w * prio_data.A_proj_w.transpose();
+    prio_data.gram_ldlt.compute(prio_data.gram);
+    if(prio_data.gram_ldlt.info() != Eigen::Success || !prio_data.gram_ldlt.isPositive())
+        return false;
+    prio_data.gram_inv.setIdentity();
+    prio_data.gram_ldlt.solveInPlace(prio_data.gram_inv);
+
+    // The smallest eigenvalue of the Gram matrix is the squared smallest singular value of A_proj_w. Since ||G^-1||_2 <= ||G^-1||_F,
+    // 1/||G^-1||_F is a lower bound for it. If this bound is above the damping threshold (see computeSVDInverse()), the damped and the
+    // undamped inverse are identical and no singular value is truncated, so that no SVD is required. Otherwise fall back to the SVD.
+    const double s_min_sq_bound = 1.0 / prio_data.gram_inv.norm();
+    const double s_threshold = max(1/max_solver_output_norm, min_eigenvalue);
+    if(!(s_min_sq_bound >= s_threshold*s_threshold))
+        return false;
+
+    // A^# = Wq^-1 * A_proj_w^T * (A_proj_w * A_proj_w^T)^-1 * Wy
+    prio_data.damping = 0;
+    prio_data.rank = prio_data.n_constraint_variables;
+    prio_data.A_proj_inv_wls.noalias() = prio_data.A_proj_w.transpose() * prio_data.gram_inv;
+    prio_data.A_proj_inv_wls = prio_data.joint_weights.asDiagonal() * prio_data.A_proj_inv_wls * prio_data.constraint_weights.asDiagonal();
+    prio_data.A_proj_inv_wdls = prio_data.A_proj_inv_wls;
+
+    // Singular values are not computed with this decomposition
+    prio_data.sing_vals.setConstant(std::numeric_limits<double>::quiet_NaN());
 
-    ///////////////
+    return true;
 }
 
 void HierarchicalLSSolver::setJointWeights(const base::VectorXd& weights){
@@ -191,14 +262,12 @@ void HierarchicalLSSolver::setJointWeights(const base::VectorXd& weights, const
                                     ". Number of priority levels is " + to_string(priorities.size()));
 
     if(weights.size() == no_of_joints){
-        priorities[prio].joint_weight_mat.setZero();
         for(uint i = 0; i < no_of_joints; i++)
         {
-            if(weights(i) >= 0)
-                priorities[prio].joint_weight_mat(i,i) = sqrt(weights(i));
-            else
+            if(weights(i) < 0)
                 throw std::invalid_argument("Entries of joint weight vector have to be >= 0, but element " + to_string(i) + " is " + to_string(weights(i)));
         }
+        priorities[prio].joint_weights = weights.cwiseSqrt();
     }
     else{
         throw std::invalid_argument("Cannot set joint weights. Size of joint weight vector is " + to_string(weights.size()) + " but should be " + to_string(no_of_joints));
@@ -216,14 +285,11 @@ void HierarchicalLSSolver::setTaskWeights(const base::VectorXd& weights, const u
     if(priorities[prio].n_constraint_variables != weights.size())
         throw std::invalid_argument("Cannot set joint weights. Size of joint weight vector is " + to_string(weights.size())
                                     + " but should be " + to_string(priorities[prio].n_constraint_variables));
-    priorities[prio].constraint_weight_mat.setZero();
     for(uint i = 0; i < priorities[prio].n_constraint_variables; i++){
-        if(weights(i) >= 0)
-           priorities[prio].constraint_weight_mat(i,i) = sqrt(weights(i));
-        else
+        if(weights(i) < 0)
             throw std::invalid_argument("Entries of constraint weight vector have to be >= 0, but element " + to_string(i) + " is " + to_string(weights(i)));
-
     }
+    priorities[prio].constraint_weights = weights.cwiseSqrt();
 }
 
 void HierarchicalLSSolver::setMinEigenvalue(double _min_eigenvalue){
@@ -239,4 +305,10 @@ void HierarchicalLSSolver::setMaxSolverOutputNorm(double norm_max){
     }
     max_solver_output_norm = norm_max;
 }
+
+void HierarchicalLSSolver::setDecomposition(HLSDecomposition _decomposition){
+    if(_decomposition < hls_kdl_svd || _decomposition > hls_ldlt)
+        throw std::invalid_argument("Invalid HLS decomposition: " + to_string(_decomposition));
+    decomposition = _decomposition;
+}
 }
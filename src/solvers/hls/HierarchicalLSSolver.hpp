@@ -2,13 +2,26 @@
 #define WBC_SOLVERS_HIERARCHICAL_LS_SOLVER_HPP
 
 #include <base/Eigen.hpp>
+#include <Eigen/SVD>
+#include <Eigen/Cholesky>
 #include <vector>
+#include <algorithm>
 #include "../../core/QPSolver.hpp"
 
 namespace wbc{
 
 class HierarchicalQP;
 
+/** Decomposition used to compute the (damped) pseudo-inverse on each priority level:
+ *   - hls_kdl_svd: Iterative Householder/QR SVD ported from KDL (tools/SVD.hpp)
+ *   - hls_jacobi_svd: Eigen::JacobiSVD. Very accurate, fastest for small matrices
+ *   - hls_bdc_svd: Eigen::BDCSVD. Divide and conquer SVD, fastest for large matrices (falls back to Jacobi SVD for small ones internally)
+ *   - hls_ldlt: Pseudo-inverse \f$\mathbf{A}^T(\mathbf{A}\mathbf{A}^T)^{-1}\f$ computed from an LDLT decomposition of the (small) Gram matrix. This is
+ *               only used on priorities where the Gram matrix is provably well-conditioned, i.e. where no damping is required. All other priorities
+ *               (rank deficient, close to singular or more rows than joints) fall back to hls_bdc_svd. No singular values are computed on priorities solved with LDLT.
+ */
+enum HLSDecomposition{hls_kdl_svd, hls_jacobi_svd, hls_bdc_svd, hls_ldlt};
+
 /**
  * @brief Implementation of the hierarchical weighted damped least squares solver (HWLS), similar to
  * Schutter, J. et al. “Constraint-based Task Specification and Estimation for Sensor-Based Robot Systems in the Presence of Geometric Uncertainty.” The International Journal of Robotics Research 26 (2007): 433 - 455.
@@ -28,6 +41,7 @@ class HierarchicalQP;
  * of priority level i.
  * The solver ensures a hierarchy between the different tasks using nullspace projections. That is, the equation system with the highest priority will be solved fully if (n_rows <= n_cols),
  * the eqn. system of the next priority will be solved in the nullspace of the priovious priority, and so on. Additionally the solver can include weights in joint space and task space.
+ * The solution is computed in closed form, so a time budget (see QPSolver::setTimeBudget()) has no effect.
  */
 class HierarchicalLSSolver : public QPSolver{
 private:
@@ -48,15 +62,20 @@ public:
             A_proj.setZero(_n_constraint_variables, n_joints);
             A_proj_w.setZero(_n_constraint_variables,n_joints);
             U.setZero(_n_constraint_variables, n_joints);
-            A_proj_inv_wls.setZero(_n_constraint_variables, n_joints);
-            A_proj_inv_wdls.setZero(_n_constraint_variables, n_joints);
+            A_proj_inv_wls.setZero(n_joints, _n_constraint_variables);
+            A_proj_inv_wdls.setZero(n_joints, _n_constraint_variables);
             y_comp.setZero(_n_constraint_variables);
-            constraint_weight_mat.resize(_n_constraint_variables, _n_constraint_variables);
-            constraint_weight_mat.setIdentity();
-            joint_weight_mat.resize(n_joints, n_joints);
-            joint_weight_mat.setIdentity();
+            constraint_weights.setOnes(_n_constraint_variables);
+            joint_weights.setOnes(n_joints);
             u_t_weight_mat.setZero(n_joints, _n_constraint_variables);
+            u_t_weight_mat_A_proj.setZero(std::min(_n_constraint_variables, n_joints), n_joints);
+            rank = 0;
             sing_vals.resize(n_joints);
+            jacobi_svd = Eigen::JacobiSVD<base::MatrixXd>(_n_constraint_variables, n_joints, Eigen::ComputeThinU | Eigen::ComputeThinV);
+            bdc_svd = Eigen::BDCSVD<base::MatrixXd>(_n_constraint_variables, n_joints, Eigen::ComputeThinU | Eigen::ComputeThinV);
+            gram.setZero(_n_constraint_variables, _n_constraint_variables);
+            gram_inv.setZero(_n_constraint_variables, _n_constraint_variables);
+            gram_ldlt = Eigen::LDLT<base::MatrixXd>(_n_constraint_variables);
         }
         base::VectorXd solution_prio;         /** Solution for the current priority*/
         base::MatrixXd A_proj;                /** Constraint Matrix projected into nullspace of the higher priority */
@@ -65,12 +84,19 @@ public:
         base::MatrixXd A_proj_inv_wls;        /** Least square inverse of A_proj_w*/
         base::MatrixXd A_proj_inv_wdls;       /** Damped Least square inverse of A_proj_w*/
         base::VectorXd y_comp;                /** Input variables which are compensated for the part of solution already met in higher priorities */
-        base::MatrixXd constraint_weight_mat; /** Constraint weight matrix of this priority*/
-        base::MatrixXd joint_weight_mat;      /** Joint weight matrix of this priority*/
-        base::MatrixXd u_t_weight_mat;        /** Matrix U_transposed * constraint_weight_mat*/
+        base::VectorXd constraint_weights;    /** Diagonal of the constraint weight matrix of this priority (square root of the constraint weights)*/
+        base::VectorXd joint_weights;         /** Diagonal of the joint weight matrix of this priority (square root of the joint weights)*/
+        base::MatrixXd u_t_weight_mat;        /** Matrix U_transposed * constraint weight matrix*/
+        base::MatrixXd u_t_weight_mat_A_proj; /** u_t_weight_mat * A_proj, used for the low rank update of the projection matrix*/
         base::VectorXd sing_vals;             /** Singular values of this priority */
         double damping;                        /** Damping term for matrix inversion on this priority*/
         unsigned int n_constraint_variables;   /** Number of constraint variables of this priority*/
+        unsigned int rank;                     /** Numerical rank of A_proj_w, i.e. number of singular values >= min_eigenvalue*/
+        Eigen::JacobiSVD<base::MatrixXd> jacobi_svd; /** Pre-allocated Jacobi SVD of A_proj_w (hls_jacobi_svd)*/
+        Eigen::BDCSVD<base::MatrixXd> bdc_svd;       /** Pre-allocated divide and conquer SVD of A_proj_w (hls_bdc_svd, hls_ldlt)*/
+        base::MatrixXd gram;                  /** Gram matrix A_proj_w * A_proj_w^T (hls_ldlt)*/
+        base::MatrixXd gram_inv;              /** Inverse of the Gram matrix (hls_ldlt)*/
+        Eigen::LDLT<base::MatrixXd> gram_ldlt; /** Pre-allocated LDLT decomposition of the Gram matrix (hls_ldlt)*/
     };
 
     HierarchicalLSSolver();
@@ -134,27 +160,44 @@ public:
     /** Return the maximum norm term.*/
     double getMaxSolverOutputNorm(){return max_solver_output_norm;}
 
+    /**
+     * @brief setDecomposition Sets the decomposition that is used to compute the pseudo-inverse on each priority level. Default is hls_kdl_svd.
+     *        See HLSDecomposition for the available options.
+     */
+    void setDecomposition(HLSDecomposition decomposition);
+
+    /** Return the decomposition used to compute the pseudo-inverse.*/
+    HLSDecomposition getDecomposition(){return decomposition;}
+
     /**
      * @brief Has configure() been  called already?
      */
     bool isConfigured(){return configured;}
 
 protected:
+    /** Compute the damped and undamped weighted pseudo-inverse of the given priority from the SVD of A_proj_w*/
+    void computeSVDInverse(PriorityData& prio_data);
+
+    /** Compute the weighted pseudo-inverse of the given priority via LDLT of the Gram matrix. Returns false (and does not
+     *  modify the inverses) if the Gram matrix cannot be shown to be well-conditioned. In that case, the SVD has to be used*/
+    bool computeLDLTInverse(PriorityData& prio_data);
+
     std::vector<PriorityData> priorities;     /** Contains priority specific matrices etc. */
     base::MatrixXd proj_mat;                 /** Projection Matrix that performs the nullspace projection onto the next lower priority*/
     base::VectorXd s_vals;                   /** Singular value vector*/
-    base::MatrixXd s_vals_inv;               /** Diagonal matrix containing the reciprocal singular values*/
+    base::VectorXd s_vals_inv;               /** Reciprocal singular values*/
     base::MatrixXd sing_vect_r;              /** Matrix of right singular vectors*/
-    base::MatrixXd damped_s_vals_inv;        /** Diagonal matrix containing the reciprocal singular values with damping*/
+    base::VectorXd damped_s_vals_inv;        /** Reciprocal singular values with damping*/
     base::MatrixXd Wq_V;                     /** Column weight matrix times Matrix of Vectors of right singular vectors*/
-    base::MatrixXd Wq_V_s_vals_inv;          /** Wq_V * s_vals_inv */
-    base::MatrixXd Wq_V_damped_s_vals_inv;   /** Wq_V * damped_s_vals_inv */
+    base::MatrixXd Wq_V_s_vals_inv;          /** Wq_V * diag(s_vals_inv) */
+    base::MatrixXd Wq_V_damped_s_vals_inv;   /** Wq_V * diag(damped_s_vals_inv) */
 
     unsigned int no_of_joints;             /** Number of joints */
 
     //Properties
     double min_eigenvalue;    /** Precision for eigenvalue inversion. Inverse of an Eigenvalue smaller than this will be set to zero*/
     double max_solver_output_norm;   /** Maximum norm of (J#) * y */
+    HLSDecomposition decomposition;  /** Decomposition used to compute the pseudo-inverse*/
 
     //Helpers
     base::VectorXd tmp;
@@ -73,5 +73,58 @@ BOOST_AUTO_TEST_CASE(solver_hls)
     for(uint j = 0; j < NO_EQ_CONSTRAINTS; j++)
         BOOST_CHECK(fabs(test(j) - y(j)) < 1e-9);
 
+    const SolverStats& stats = solver.getStats();
+    BOOST_CHECK(stats.status == 0);
+    BOOST_CHECK(stats.solve_time > 0);
+    BOOST_CHECK(stats.n_iter == -1);
+    BOOST_CHECK(stats.primal_residual < 1e-9);
+    BOOST_CHECK(std::isnan(stats.dual_residual));
+
     //cout<<"\n............................."<<endl;
 }
+
+BOOST_AUTO_TEST_CASE(solver_hls_decompositions)
+{
+    // All decompositions have to yield the same solution as the default (KDL SVD), both for regular problems and for problems with
+    // rank deficient priorities, where the hls_ldlt decomposition has to fall back to the SVD
+
+    srand(42);
+
+    const uint NO_JOINTS = 10;
+    vector<int> ny_per_prio = {6, 3, 2};
+
+    wbc::HierarchicalQP hqp;
+    hqp.Wq.setRandom(NO_JOINTS);
+    hqp.Wq = hqp.Wq.cwiseAbs();
+    for(int ny : ny_per_prio){
+        wbc::QuadraticProgram qp;
+        qp.resize(NO_JOINTS, ny, 0, false);
+        qp.A.setRandom();
+        qp.b.setRandom();
+        qp.Wy.setOnes();
+        hqp << qp;
+    }
+
+    for(int singular = 0; singular < 2; singular++){
+        if(singular)
+            hqp[0].A.row(1) = hqp[0].A.row(0);
+
+        HierarchicalLSSolver kdl_solver;
+        BOOST_CHECK(kdl_solver.configure(ny_per_prio, NO_JOINTS));
+        base::VectorXd kdl_output;
+        kdl_solver.solve(hqp, kdl_output);
+
+        for(HLSDecomposition decomposition : {hls_jacobi_svd, hls_bdc_svd, hls_ldlt}){
+            HierarchicalLSSolver solver;
+            BOOST_CHECK(solver.configure(ny_per_prio, NO_JOINTS));
+            solver.setDecomposition(decomposition);
+            BOOST_CHECK(solver.getDecomposition() == decomposition);
+
+            base::VectorXd solver_output;
+            solver.solve(hqp, solver_output);
+            BOOST_CHECK(solver_output.size() == NO_JOINTS);
+            for(uint i = 0; i < NO_JOINTS; i++)
+                BOOST_CHECK(fabs(solver_output(i) - kdl_output(i)) < 1e-6);
+        }
+    }
+}
@@ -0,0 +1,262 @@
+#include "HierarchicalQPSolver.hpp"
+#include "../../core/QuadraticProgram.hpp"
+#include <stdexcept>
+#include <algorithm>
+
+using namespace qpOASES;
+using namespace std;
+
+namespace wbc{
+
+QPSolverRegistry<HierarchicalQPSolver> HierarchicalQPSolver::reg("hqp");
+
+HierarchicalQPSolver::HierarchicalQPSolver() :
+    n_wsr(1000),
+    fixing_tolerance(1e-6),
+    regularization(1e-9),
+    budget_tolerance(1e-6),
+    nq(0){
+    options.setToFast();
+    options.printLevel = PL_NONE;
+}
+
+HierarchicalQPSolver::~HierarchicalQPSolver(){
+}
+
+void HierarchicalQPSolver::configure(const wbc::HierarchicalQP &hierarchical_qp){
+
+    if(hierarchical_qp.size() == 0)
+        throw std::invalid_argument("HierarchicalQPSolver: Number of priority levels has to be > 0");
+
+    nq = hierarchical_qp[0].nq;
+    if(nq == 0)
+        throw std::invalid_argument("HierarchicalQPSolver: Number of joints has to be > 0");
+
+    levels.resize(hierarchical_qp.size());
+    uint n_fixed = 0;
+    for(uint prio = 0; prio < hierarchical_qp.size(); prio++){
+        const QuadraticProgram& qp = hierarchical_qp[prio];
+        if((uint)qp.nq != nq)
+            throw std::invalid_argument("HierarchicalQPSolver: Number of joints on priority level " + to_string(prio) +
+                                        " is " + to_string(qp.nq) + ", but should be " + to_string(nq));
+        Level& level = levels[prio];
+        level.neq = qp.neq;
+        level.nin = qp.nin;
+        level.n_fixed = n_fixed;
+        level.ns = qp.soft_constraints ? level.neq + level.nin : 0;
+        const uint nv = nq + level.ns;
+        const uint nc = n_fixed + level.neq + level.nin;
+
+        level.sq_problem = SQProblem(nv, nc);
+        level.sq_problem.setOptions(options);
+        level.actual_n_wsr = 0;
+
+        // The slack blocks are constant, so they are only set once here
+        level.H.setZero(nv, nv);
+        level.A.setZero(nc, nv);
+        level.A.block(n_fixed, nq, level.ns, level.ns).diagonal().setConstant(-1);
+        level.g.setZero(nv);
+        level.lb.setConstant(nv, -INFTY);
+        level.ub.setConstant(nv, INFTY);
+        level.lbA.setZero(nc);
+        level.ubA.setZero(nc);
+        level.solution.setZero(nv);
+        level.slacks.setZero(level.ns);
+        level.fixed_lower.setZero(level.neq + level.nin);
+        level.fixed_upper.setZero(level.neq + level.nin);
+
+        n_fixed += level.neq + level.nin;
+    }
+    configured = true;
+}
+
+void HierarchicalQPSolver::solve(const wbc::HierarchicalQP &hierarchical_qp, base::VectorXd &solver_output){
+
+    SolveTimer timer(stats);
+
+    if(!configured)
+        configure(hierarchical_qp);
+
+    if(hierarchical_qp.size() != levels.size())
+        throw std::invalid_argument("HierarchicalQPSolver: Number of priority levels in solver: " + to_string(levels.size()) +
+                                    ", Size of input vector: " + to_string(hierarchical_qp.size()));
+
+    stats.n_iter = 0;
+    uint n_solved = 0;
+    for(uint prio = 0; prio < levels.size(); prio++){
+
+        // Time budget: If it is exhausted, stop here and return the solution of the previous priority level, which is optimal w.r.t. all higher priority levels
+        const real_t remaining_time = time_budget - timer.elapsed();
+        if(time_budget > 0 && remaining_time <= 0 && prio > 0){
+            stats.budget_exceeded = true;
+            break;
+        }
+
+        const QuadraticProgram& qp = hierarchical_qp[prio];
+        qp.check();
+        Level& level = levels[prio];
+        if((uint)qp.nq != nq || (uint)qp.neq != level.neq || (uint)qp.nin != level.nin)
+            throw std::invalid_argument("HierarchicalQPSolver: Expected problem size on priority level " + to_string(prio) + ": nq: " + to_string(nq) +
+                                        ", neq: " + to_string(level.neq) + ", nin: " + to_string(level.nin) + ", actual: nq: " + to_string(qp.nq) +
+                                        ", neq: " + to_string(qp.neq) + ", nin: " + to_string(qp.nin));
+        if((qp.soft_constraints ? level.neq + level.nin : 0) != level.ns)
+            throw std::invalid_argument("HierarchicalQPSolver: soft_constraints flag on priority level " + to_string(prio) + " changed. Call reset() first");
+        const uint ns = level.ns;
+
+        // Cost function: Regularization of the joint variables and weighted slack variables
+        if(qp.H.size() != 0)
+            level.H.topLeftCorner(nq,nq) = qp.H;
+        else
+            level.H.topLeftCorner(nq,nq).setZero();
+        level.H.topLeftCorner(nq,nq).diagonal().array() += regularization;
+        if(qp.Wy.size() == ns)
+            level.H.bottomRightCorner(ns,ns).diagonal() = qp.Wy;
+        else
+            level.H.bottomRightCorner(ns,ns).diagonal().setOnes();
+        if(qp.g.size() != 0)
+            level.g.head(nq) = qp.g;
+        else
+            level.g.head(nq).setZero();
+
+        // Constraints of all higher priority levels, fixed at their optimum
+        uint row = 0;
+        for(uint j = 0; j < prio; j++){
+            const Level& higher = levels[j];
+            level.A.block(row, 0, higher.neq, nq) = hierarchical_qp[j].A;
+            level.A.block(row + higher.neq, 0, higher.nin, nq) = hierarchical_qp[j].C;
+            level.lbA.segment(row, higher.neq + higher.nin) = higher.fixed_lower;
+            level.ubA.segment(row, higher.neq + higher.nin) = higher.fixed_upper;
+            row += higher.neq + higher.nin;
+        }
+
+        // Constraints of this level, relaxed by the slack variables if they are soft
+        level.A.block(row, 0, level.neq, nq) = qp.A;
+        level.A.block(row + level.neq, 0, level.nin, nq) = qp.C;
+        level.lbA.segment(row, level.neq) = qp.b;
+        level.ubA.segment(row, level.neq) = qp.b;
+        level.lbA.segment(row + level.neq, level.nin) = qp.lower_y.cwiseMax(-INFTY);
+        level.ubA.segment(row + level.neq, level.nin) = qp.upper_y.cwiseMin(INFTY);
+
+        // Joint space bounds of this and all higher priority levels
+        level.lb.head(nq).setConstant(-INFTY);
+        level.ub.head(nq).setConstant(INFTY);
+        for(uint j = 0; j <= prio; j++){
+            if(hierarchical_qp[j].bounded){
+                level.lb.head(nq) = level.lb.head(nq).cwiseMax(hierarchical_qp[j].lower_x);
+                level.ub.head(nq) = level.ub.head(nq).cwiseMin(hierarchical_qp[j].upper_x);
+            }
+        }
+
+        // Warm start from the solution of this level in the previous cycle
+        level.actual_n_wsr = n_wsr;
+        real_t cputime = remaining_time;
+        real_t* cputime_ptr = (time_budget > 0 && remaining_time > 0) ? &cputime : 0;
+        returnValue ret_val;
+        if(!level.sq_problem.isInitialised())
+            ret_val = level.sq_problem.init(level.H.data(), level.g.data(), level.A.data(), level.lb.data(), level.ub.data(),
+                                            level.lbA.data(), level.ubA.data(), level.actual_n_wsr, cputime_ptr);
+        else
+            ret_val = level.sq_problem.hotstart(level.H.data(), level.g.data(), level.A.data(), level.lb.data(), level.ub.data(),
+                                                level.lbA.data(), level.ubA.data(), level.actual_n_wsr, cputime_ptr);
+        stats.status = ret_val;
+        stats.n_iter += level.actual_n_wsr;
+        if(ret_val != SUCCESSFUL_RETURN && cputime_ptr && cputime >= remaining_time){
+            stats.budget_exceeded = true;
+            // On the highest priority level, use the solution of the last intermediate QP of the qpOASES homotopy, if it satisfies the
+            // current bounds and constraints of the level up to the budget tolerance. Otherwise use the last solution
+            if(prio == 0){
+                if(level.sq_problem.getPrimalSolution(level.solution.data()) != RET_QP_NOT_SOLVED && levelResidual(level) <= budget_tolerance)
+                    n_solved = 1;
+                else if(last_solution.size() == nq){
+                    solver_output = last_solution;
+                    return;
+                }
+                else
+                    throw std::runtime_error("HierarchicalQPSolver: Time budget exceeded before a feasible solution of priority level 0 was found");
+            }
+            break;
+        }
+        if(ret_val != SUCCESSFUL_RETURN){
+            qp.print();
+            throw std::runtime_error("HierarchicalQPSolver: Solving priority level " + to_string(prio) + " failed with error " + to_string(ret_val));
+        }
+        if(level.sq_problem.getPrimalSolution(level.solution.data()) == RET_QP_NOT_SOLVED)
+            throw std::runtime_error("HierarchicalQPSolver: getPrimalSolution() on priority level " + to_string(prio) + " returned " + to_string(RET_QP_NOT_SOLVED));
+        level.slacks = level.solution.tail(ns);
+        n_solved = prio + 1;
+
+        // Fix the constraints of this level for all lower priority levels: Equality constraints at their achieved value,
+        // inequality constraints relaxed by the achieved violation
+        if(prio + 1 < levels.size()){
+            const auto x = level.solution.head(nq);
+            level.fixed_lower.head(level.neq).noalias() = qp.A * x;
+            level.fixed_upper.head(level.neq) = level.fixed_lower.head(level.neq).array() + fixing_tolerance;
+            level.fixed_lower.head(level.neq).array() -= fixing_tolerance;
+            level.fixed_lower.tail(level.nin).noalias() = qp.C * x;
+            level.fixed_upper.tail(level.nin) = level.fixed_lower.tail(level.nin).array() + fixing_tolerance;
+            level.fixed_lower.tail(level.nin).array() -= fixing_tolerance;
+            level.fixed_lower.tail(level.nin) = level.fixed_lower.tail(level.nin).cwiseMin(qp.lower_y).cwiseMax(-INFTY);
+            level.fixed_upper.tail(level.nin) = level.fixed_upper.tail(level.nin).cwiseMax(qp.upper_y).cwiseMin(INFTY);
+        }
+    }
+
+    // Solution of the lowest priority level that has been solved. Only differs from the last level if the time budget has been exceeded
+    const Level& lowest = levels[n_solved-1];
+    solver_output = lowest.solution.head(nq);
+    if(!stats.budget_exceeded)
+        last_solution = solver_output;
+
+    // Active set of the lowest solved priority level, which contains the constraints of all higher levels. Its own equality constraints are
+    // always active. Slack variables are unbounded, so only the joint variables can be at their bounds
+    stats.n_active = lowest.sq_problem.getNAC() - lowest.neq + lowest.sq_problem.getNV() - lowest.sq_problem.getNFR();
+    stats.primal_residual = hierarchical_qp[0].primalResidual(solver_output);
+}
+
+double HierarchicalQPSolver::levelResidual(const Level& level){
+    double residual = 0;
+    for(int i = 0; i < level.A.rows(); i++){
+        const double y = level.A.row(i).dot(level.solution);
+        residual = std::max(residual, std::max(level.lbA[i] - y, y - level.ubA[i]));
+    }
+    for(int i = 0; i < level.solution.size(); i++)
+        residual = std::max(residual, std::max(level.lb[i] - level.solution[i], level.solution[i] - level.ub[i]));
+    return residual;
+}
+
+void HierarchicalQPSolver::setBudgetTolerance(double tol){
+    if(tol < 0)
+        throw std::invalid_argument("HierarchicalQPSolver: Budget tolerance has to be >= 0");
+    budget_tolerance = tol;
+}
+
+int HierarchicalQPSolver::getNoWSR(uint prio){
+    if(prio >= levels.size())
+        throw std::invalid_argument("HierarchicalQPSolver: Invalid priority level " + to_string(prio) + ". Number of priority levels is " + to_string(levels.size()));
+    return levels[prio].actual_n_wsr;
+}
+
+const base::VectorXd& HierarchicalQPSolver::getSlacks(uint prio){
+    if(prio >= levels.size())
+        throw std::invalid_argument("HierarchicalQPSolver: Invalid priority level " + to_string(prio) + ". Number of priority levels is " + to_string(levels.size()));
+    return levels[prio].slacks;
+}
+
+void HierarchicalQPSolver::setOptions(const qpOASES::Options& opt){
+    options = opt;
+    for(Level& level : levels)
+        level.sq_problem.setOptions(options);
+}
+
+void HierarchicalQPSolver::setFixingTolerance(double tol){
+    if(tol < 0)
+        throw std::invalid_argument("HierarchicalQPSolver: Fixing tolerance has to be >= 0");
+    fixing_tolerance = tol;
+}
+
+void HierarchicalQPSolver::setRegularization(double reg){
+    if(reg < 0)
+        throw std::invalid_argument("HierarchicalQPSolver: Regularization has to be >= 0");
+    regularization = reg;
+}
+
+}
@@ -0,0 +1,121 @@
+#ifndef WBC_SOLVERS_HIERARCHICAL_QP_SOLVER_HPP
+#define WBC_SOLVERS_HIERARCHICAL_QP_SOLVER_HPP
+
+#include "../../core/QPSolver.hpp"
+#include <qpOASES.hpp>
+#include <base/Eigen.hpp>
+
+namespace wbc {
+
+class HierarchicalQP;
+
+/**
+ * @brief The HierarchicalQPSolver solves a hierarchy of quadratic programs with equality and inequality constraints with strict priorities, similar to
+ * Kanoun, O. et al. "Kinematic Control of Redundant Manipulators: Generalizing the Task-Priority Framework to Inequality Task." IEEE Transactions on Robotics 27 (2011): 785 - 792.
+ *
+ * The priority levels are solved in sequence. On priority level k, the following QP is solved using qpOASES:
+ *  \f[
+ *        \begin{array}{ccc}
+ *        min(\mathbf{x},\mathbf{w},\mathbf{v}) & \frac{1}{2} \mathbf{x}^T\mathbf{H}_k\mathbf{x}+\mathbf{x}^T\mathbf{g}_k + \frac{1}{2}\mathbf{w}^T\mathbf{W}_{y,eq}\mathbf{w} + \frac{1}{2}\mathbf{v}^T\mathbf{W}_{y,in}\mathbf{v}& \\
+ *             & & \\
+ *        s.t. & \mathbf{A}_k\mathbf{x} - \mathbf{w} = \mathbf{b}_k& \\
+ *             & lb(\mathbf{y}_k) \leq \mathbf{C}_k\mathbf{x} - \mathbf{v} \leq ub(\mathbf{y}_k)& \\
+ *             & lb(\mathbf{x}) \leq \mathbf{x} \leq ub(\mathbf{x})& \\
+ *             & \textrm{Constraints of priority levels} \ 0 \dots k-1 \ \textrm{fixed at their optimum}& \\
+ *        \end{array}
+ *  \f]
+ *
+ * where w and v are slack variables that allow the constraints of level k to be violated if they conflict with the higher priority levels. Slack variables are only
+ * added if the constraints of the level are tasks (see QuadraticProgram::soft_constraints, e.g. VelocityScene). Otherwise, they are hard constraints and H_k, g_k
+ * are the cost function of the level, as in the QP based scenes (e.g. AccelerationSceneTSID). After solving a level,
+ * its equality constraints are fixed to the achieved values (within the fixing tolerance) and its inequality constraints are relaxed by the achieved slack, so that
+ * lower priority levels cannot change the solution of the higher priority levels. For soft constraints, H_k and g_k act as regularization of level k and should be
+ * small compared to the constraint weights W_y. Joint space bounds are hard constraints on the level they are given on and on all lower priority levels. The solution of the lowest priority level is the solver output.
+ *
+ * Each priority level uses its own qpOASES problem instance, which is warm started from the solution of the same level in the previous cycle.
+ *
+ * If a time budget is set (see QPSolver::setTimeBudget()), the remaining time is passed to qpOASES on each level. If the budget is exhausted, the
+ * solution of the last completely solved priority level is returned, which is optimal w.r.t. all higher priority levels. If the budget is exhausted on the
+ * highest priority level, the intermediate qpOASES solution is only returned if it is feasible (see setBudgetTolerance()), otherwise the last solution.
+ */
+class HierarchicalQPSolver : public QPSolver{
+private:
+    static QPSolverRegistry<HierarchicalQPSolver> reg;
+
+public:
+    HierarchicalQPSolver();
+    virtual ~HierarchicalQPSolver();
+
+    /**
+     * @brief solve Solve the given hierarchy of quadratic programs
+     * @param hierarchical_qp Description of the hierarchical quadratic program to solve. The number of priority levels, the problem size and the
+     *                        soft_constraints flag of each level must not change without calling reset()
+     * @param solver_output solution of the lowest priority level
+     */
+    virtual void solve(const wbc::HierarchicalQP &hierarchical_qp, base::VectorXd &solver_output);
+
+    /** Set the maximum number of working set recalculations per priority level*/
+    void setMaxNoWSR(const uint& n){n_wsr = n;}
+    /** Get the maximum number of working set recalculations per priority level*/
+    uint getMaxNoWSR(){return n_wsr;}
+    /** Get number of working set recalculations actually performed on the given priority level in the last call to solve()*/
+    int getNoWSR(uint prio);
+    /** Return current solver options*/
+    qpOASES::Options getOptions(){return options;}
+    /** Set new solver options. Will be applied to all priority levels*/
+    void setOptions(const qpOASES::Options& opt);
+    /** Set the tolerance by which the equality constraints of a higher priority level may deviate from their optimal value on the lower priority levels. Has to be >= 0*/
+    void setFixingTolerance(double tol);
+    /** Get the fixing tolerance*/
+    double getFixingTolerance(){return fixing_tolerance;}
+    /** Set the regularization term that is added to the diagonal of the Hessian (joint variables only) on each priority level. Has to be >= 0*/
+    void setRegularization(double reg);
+    /** Get the regularization term*/
+    double getRegularization(){return regularization;}
+    /** Set the max. violation of the bounds and constraints of the highest priority level by the intermediate qpOASES solution, so that it is
+     *  returned if the time budget is exceeded on that level. Otherwise the last solution is returned. Has to be >= 0*/
+    void setBudgetTolerance(double tol);
+    /** Get the budget tolerance*/
+    double getBudgetTolerance(){return budget_tolerance;}
+    /** Return the slack variables (first the equality, then the inequality constraint slacks) of the given priority level from the last call to solve().
+     *  Empty if the constraints of the level are hard*/
+    const base::VectorXd& getSlacks(uint prio);
+
+protected:
+    typedef Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> RowMajorMatrix;
+
+    /** Sub-QP of a single priority level. Variables are [x w v]^T (w and v only for soft constraints), constraints are [constraints of all higher levels, equalities, inequalities]*/
+    struct Level{
+        uint neq;                       /** Number of equality constraints of this level*/
+        uint nin;                       /** Number of inequality constraints of this level*/
+        uint n_fixed;                   /** Number of constraints of all higher priority levels*/
+        uint ns;                        /** Number of slack variables: neq+nin if the constraints of this level are soft, otherwise 0*/
+        qpOASES::SQProblem sq_problem;  /** qpOASES problem instance of this level*/
+        int actual_n_wsr;               /** Number of working set recalculations in the last solve*/
+        RowMajorMatrix H;               /** Hessian, (nq+ns) x (nq+ns)*/
+        RowMajorMatrix A;               /** Constraint matrix, (n_fixed+neq+nin) x (nq+ns)*/
+        base::VectorXd g, lb, ub, lbA, ubA;
+        base::VectorXd solution;        /** Solution of this level, including slack variables*/
+        base::VectorXd slacks;          /** Slack variables of this level*/
+        base::VectorXd fixed_lower;     /** Lower bound of the constraints of this level on all lower priority levels*/
+        base::VectorXd fixed_upper;     /** Upper bound of the constraints of this level on all lower priority levels*/
+    };
+
+    /** Allocate the sub-QPs of all priority levels*/
+    void configure(const wbc::HierarchicalQP &hierarchical_qp);
+
+    /** Max. violation of the bounds and constraints of the given level by its current solution*/
+    static double levelResidual(const Level& level);
+
+    std::vector<Level> levels;
+    qpOASES::Options options;
+    int n_wsr;
+    double fixing_tolerance;
+    double regularization;
+    double budget_tolerance;
+    uint nq;
+};
+
+}
+
+#endif
@@ -0,0 +1,143 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+#include "core/QuadraticProgram.hpp"
+#include "solvers/hqp/HierarchicalQPSolver.hpp"
+#include <Eigen/SVD>
+
+using namespace wbc;
+using namespace std;
+
+BOOST_AUTO_TEST_CASE(solver_hqp_equality_constraints)
+{
+    // Two conflicting equality tasks on two priority levels: The result has to be the same as the classical nullspace projection solution
+    // x = A0^# * b0 + N0 * (A1*N0)^# * (b1 - A1 * A0^# * b0)
+
+    srand(42);
+
+    const int NO_JOINTS = 6;
+
+    HierarchicalQP hqp;
+    QuadraticProgram qp0, qp1;
+    qp0.resize(NO_JOINTS, 3, 0, false);
+    qp0.soft_constraints = true;
+    qp0.A.setRandom();
+    qp0.b.setRandom();
+    qp0.H.setZero();
+    qp0.g.setZero();
+    qp1.resize(NO_JOINTS, 6, 0, false);
+    qp1.soft_constraints = true;
+    qp1.A.setRandom();
+    qp1.b.setRandom();
+    qp1.H.setZero();
+    qp1.g.setZero();
+    hqp << qp0;
+    hqp << qp1;
+
+    base::MatrixXd A0_inv = qp0.A.completeOrthogonalDecomposition().pseudoInverse();
+    base::MatrixXd N0 = base::MatrixXd::Identity(NO_JOINTS,NO_JOINTS) - A0_inv*qp0.A;
+    base::MatrixXd A1N0_inv = (qp1.A*N0).completeOrthogonalDecomposition().pseudoInverse();
+    base::VectorXd x_expected = A0_inv*qp0.b + N0*A1N0_inv*(qp1.b - qp1.A*A0_inv*qp0.b);
+
+    HierarchicalQPSolver solver;
+    base::VectorXd solver_output;
+    // Solve twice to test the warm start
+    for(int i = 0; i < 2; i++){
+        BOOST_CHECK_NO_THROW(solver.solve(hqp, solver_output));
+        BOOST_CHECK(solver_output.size() == NO_JOINTS);
+
+        base::VectorXd y0 = qp0.A*solver_output;
+        for(int j = 0; j < qp0.neq; j++)
+            BOOST_CHECK(fabs(y0[j] - qp0.b[j]) < 1e-5);
+        for(int j = 0; j < NO_JOINTS; j++)
+            BOOST_CHECK(fabs(solver_output[j] - x_expected[j]) < 1e-4);
+        // First level is feasible, no slack
+        BOOST_CHECK(solver.getSlacks(0).norm() < 1e-5);
+        // Second level conflicts with first level
+        BOOST_CHECK(solver.getSlacks(1).norm() > 1e-3);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(solver_hqp_inequality_constraints)
+{
+    // Level 0: Inequality constraint x_0 + x_1 <= 0.1 and joint bounds. Level 1: x = x_ref with x_ref_0 + x_ref_1 > 0.1
+
+    const int NO_JOINTS = 4;
+
+    HierarchicalQP hqp;
+    QuadraticProgram qp0, qp1;
+    qp0.resize(NO_JOINTS, 0, 1, true);
+    qp0.C << 1, 1, 0, 0;
+    qp0.lower_y[0] = -std::numeric_limits<double>::infinity();
+    qp0.upper_y[0] = 0.1;
+    qp0.lower_x.setConstant(-1);
+    qp0.upper_x.setConstant(1);
+    qp0.H.setZero();
+    qp0.g.setZero();
+    qp1.resize(NO_JOINTS, NO_JOINTS, 0, false);
+    qp1.soft_constraints = true;
+    qp1.A.setIdentity();
+    qp1.b << 0.5, 0.5, 2.0, -0.3;
+    qp1.H.setZero();
+    qp1.g.setZero();
+    hqp << qp0;
+    hqp << qp1;
+
+    HierarchicalQPSolver solver;
+    base::VectorXd solver_output;
+    for(int i = 0; i < 2; i++){
+        BOOST_CHECK_NO_THROW(solver.solve(hqp, solver_output));
+        BOOST_CHECK(fabs(solver_output[0] - 0.05) < 1e-5);
+        BOOST_CHECK(fabs(solver_output[1] - 0.05) < 1e-5);
+        BOOST_CHECK(fabs(solver_output[2] - 1.0) < 1e-5);
+        BOOST_CHECK(fabs(solver_output[3] + 0.3) < 1e-5);
+    }
+
+    // Change the reference, so that the inequality constraint is inactive
+    hqp[1].b << -0.5, 0.2, 0.1, 0.1;
+    BOOST_CHECK_NO_THROW(solver.solve(hqp, solver_output));
+    for(int j = 0; j < NO_JOINTS; j++)
+        BOOST_CHECK(fabs(solver_output[j] - hqp[1].b[j]) < 1e-5);
+}
+
+BOOST_AUTO_TEST_CASE(solver_hqp_hard_constraints)
+{
+    // Single priority level as built by the QP based scenes (e.g. AccelerationSceneTSID): The tasks are in the cost function and the
+    // constraints are hard. The result has to satisfy the equality constraints exactly and be the same as the solution of the KKT system:
+    // x = x_ref - A^T * (A*A^T)^-1 * (A*x_ref - b)
+
+    srand(42);
+
+    const int NO_JOINTS = 6;
+
+    HierarchicalQP hqp;
+    QuadraticProgram qp;
+    qp.resize(NO_JOINTS, 3, 0, false);
+    qp.A.setRandom();
+    qp.b.setRandom();
+    base::VectorXd x_ref = base::VectorXd::Random(NO_JOINTS);
+    qp.H.setIdentity();
+    qp.g = -x_ref;
+    hqp << qp;
+
+    base::VectorXd x_expected = x_ref - qp.A.transpose() * (qp.A*qp.A.transpose()).inverse() * (qp.A*x_ref - qp.b);
+
+    HierarchicalQPSolver solver;
+    base::VectorXd solver_output;
+    for(int i = 0; i < 2; i++){
+        BOOST_CHECK_NO_THROW(solver.solve(hqp, solver_output));
+        base::VectorXd y = qp.A*solver_output;
+        for(int j = 0; j < qp.neq; j++)
+            BOOST_CHECK(fabs(y[j] - qp.b[j]) < 1e-9);
+        for(int j = 0; j < NO_JOINTS; j++)
+            BOOST_CHECK(fabs(solver_output[j] - x_expected[j]) < 1e-6);
+        BOOST_CHECK(solver.getSlacks(0).size() == 0);
+    }
+
+    // Changing the type of the constraints requires a reset
+    hqp[0].soft_constraints = true;
+    BOOST_CHECK_THROW(solver.solve(hqp, solver_output), std::invalid_argument);
+    solver.reset();
+    BOOST_CHECK_NO_THROW(solver.solve(hqp, solver_output));
+    BOOST_CHECK(solver.getSlacks(0).size() == qp.neq);
+}
@@ -15,77 +15,78 @@ ProxQPSolver::ProxQPSolver()
 {
     _n_iter = 10000;
     _eps_abs = 1e-9;
+    _eps_budget = 1e-6;
 }
 
 /// solve problem:
 /// min  0.5 * x'Hx + g'x
 /// s.t. Ax = b
 ///      l < Cx < u 
+///      lb < x < ub
 void ProxQPSolver::solve(const wbc::HierarchicalQP& hierarchical_qp, base::VectorXd& solver_output)
 {
     namespace pqp = proxsuite::proxqp;
 
+    SolveTimer timer(stats);
+
     if(hierarchical_qp.size() != 1)
         throw std::runtime_error("ProxQPSolver::solve: Constraints vector size must be 1 for the current implementation");
 
     const wbc::QuadraticProgram &qp = hierarchical_qp[0];
     qp.check();
 
-    
-    size_t n_var = qp.A.cols();
+    size_t n_var = qp.nq;
     size_t n_eq = qp.neq;
-    size_t n_in = qp.nin + qp.lower_x.size();
-
-    // merge ineuqalities and bounds together
-    _C_mtx.resize(n_in, n_var);
-    _l_vec.resize(n_in);
-    _u_vec.resize(n_in);
-
-    _C_mtx.topRows(qp.nin) = qp.C;
-    _C_mtx.bottomRows(qp.lower_x.size()).setIdentity();
-    _l_vec << qp.lower_y, qp.lower_x;
-    _u_vec << qp.upper_y, qp.upper_x;
+    size_t n_in = qp.nin;
 
+    // Joint space bounds are passed as native box constraints, so that they do not enlarge the dense inequality matrix
     if(!configured) 
     {
         _n_var_init = n_var;
         _n_eq_init = n_eq;
         _n_in_init = n_in;
+        _bounded_init = qp.bounded;
 
-        _solver_ptr = std::make_shared<pqp::dense::QP<double>>(n_var, n_eq, n_in);
+        _solver_ptr = std::make_shared<pqp::dense::QP<double>>(n_var, n_eq, n_in, qp.bounded);
         _solver_ptr->settings.eps_abs = _eps_abs;
         _solver_ptr->settings.max_iter = _n_iter;
         // _solver_ptr->settings.eps_primal_inf = 1e-6;
         // _solver_ptr->settings.preconditioner_max_iter = 100;
         // _solver_ptr->settings.initial_guess = pqp::InitialGuessStatus::NO_INITIAL_GUESS;
 
-        _solver_ptr->init(qp.H, qp.g, qp.A, qp.b, _C_mtx, _l_vec, _u_vec);
+        if(qp.bounded)
+            _solver_ptr->init(qp.H, qp.g, qp.A, qp.b, qp.C, qp.lower_y, qp.upper_y, qp.lower_x, qp.upper_x);
+        else
+            _solver_ptr->init(qp.H, qp.g, qp.A, qp.b, qp.C, qp.lower_y, qp.upper_y);
 
         configured = true;
     }
     else 
     {
-        if(n_var != _n_var_init)
-            throw std::runtime_error("QP problem changed dynamically. Not supported at the moment.");
-        if(n_in != _n_in_init)
+        if(n_var != _n_var_init || n_eq != _n_eq_init || n_in != _n_in_init || qp.bounded != _bounded_init)
             throw std::runtime_error("QP problem changed dynamically. Not supported at the moment.");
 
         _solver_ptr->settings.initial_guess = pqp::InitialGuessStatus::WARM_START_WITH_PREVIOUS_RESULT;
-        _solver_ptr->update(qp.H, qp.g, qp.A, qp.b, _C_mtx, _l_vec, _u_vec);
+        if(qp.bounded)
+            _solver_ptr->update(qp.H, qp.g, qp.A, qp.b, qp.C, qp.lower_y, qp.upper_y, qp.lower_x, qp.upper_x);
+        else
+            _solver_ptr->update(qp.H, qp.g, qp.A, qp.b, qp.C, qp.lower_y, qp.upper_y);
     }
 
 //     std::cerr << "qp.nq = " << qp.nq <<std::endl;
 //     std::cerr << "qp.neq = " << qp.neq <<std::endl;
 //     std::cerr << "qp.nin = " << qp.nin <<std::endl;
 //     std::cerr << "qp.bounded = " << qp.bounded <<std::endl;
-//     std::cerr << "l: " <<_l_vec.transpose() <<std::endl;
-//     std::cerr << "u: "<<_u_vec.transpose() <<std::endl;
-//     std::cerr << "C:\n"<<_C_mtx <<std::endl;
+//     std::cerr << "l: " << qp.lower_y.transpose() <<std::endl;
+//     std::cerr << "u: "<< qp.upper_y.transpose() <<std::endl;
+//     std::cerr << "C:\n"<< qp.C <<std::endl;
 //     std::cerr << "A:\n"<< qp.A << std::endl;
 //     std::cerr << "b: "<< qp.b << std::endl;
 //     std::cerr << "eps_abs: " << _solver_ptr->settings.eps_abs << std::endl;
 //     std::cerr << "max_iter: " << _solver_ptr->settings.max_iter << std::endl;
 
+    // Limit the number of iterations according to the time budget
+    _solver_ptr->settings.max_iter = budgetedMaxIter(_n_iter);
     _solver_ptr->solve();
     
     solver_output.resize(qp.nq);
@@ -93,6 +94,27 @@ void ProxQPSolver::solve(const wbc::HierarchicalQP& hierarchical_qp, base::Vecto
 
     auto status = _solver_ptr->results.info.status;
 
+    _actual_n_iter = _solver_ptr->results.info.iter;
+    stats.n_iter = _actual_n_iter;
+    stats.n_active = (_solver_ptr->results.z.array() != 0).count();
+    stats.primal_residual = _solver_ptr->results.info.pri_res;
+    stats.dual_residual = _solver_ptr->results.info.dua_res;
+    stats.status = (int)status;
+    updateTimePerIteration(timer.elapsed(), _actual_n_iter);
+
+    // If the iterations have been limited due to the time budget, do not throw. Return the current iterate only if it satisfies the constraints
+    // up to the budget tolerance, otherwise the last solution, if available
+    if(status == pqp::QPSolverOutput::PROXQP_MAX_ITER_REACHED && _solver_ptr->settings.max_iter < _n_iter){
+        stats.budget_exceeded = true;
+        if(_solver_ptr->results.info.pri_res <= _eps_budget)
+            return;
+        if(last_solution.size() == qp.nq){
+            solver_output = last_solution;
+            return;
+        }
+        throw std::runtime_error("ProxQP returned error status: time budget exceeded and no feasible solution available.");
+    }
+
     // if(status == pqp::QPSolverOutput::PROXQP_MAX_ITER_REACHED)
     //     std::cerr << "ProxQP returned error status: max iterations reached." << std::endl;
     // if(status == pqp::QPSolverOutput::PROXQP_PRIMAL_INFEASIBLE)
@@ -107,7 +129,7 @@ void ProxQPSolver::solve(const wbc::HierarchicalQP& hierarchical_qp, base::Vecto
     if(status == pqp::QPSolverOutput::PROXQP_DUAL_INFEASIBLE)
         throw std::runtime_error("ProxQP returned error status: problem is dual infeasible.");
 
-    _actual_n_iter = _solver_ptr->results.info.iter;
+    last_solution = solver_output;
 }
 
 } // namespace wbc
@@ -21,8 +21,10 @@ class HierarchicalQP;
  *             & & \\
  *        s.t. & \mathbf{Ax} = \mathbf{b}& \\
  *             & \mathbf{l} \leq \mathbf{Cx} \leq \mathbf{u}& \\
+ *             & \mathbf{lb} \leq \mathbf{x} \leq \mathbf{ub}& \\
  *        \end{array}
  *  \f]
+ * The variable bounds are passed to prox-qp as native box constraints (requires proxsuite >= 0.4.0), i.e. they are not added as identity rows to C.
  */
 class ProxQPSolver : public QPSolver{
 private:
@@ -49,21 +51,26 @@ public:
     /** Get number of working set recalculations actually performed*/
     int getNter(){ return _actual_n_iter; }
 
+    /** Set the max. primal residual of the current iterate, so that it is returned if the time budget is exceeded (see QPSolver::setTimeBudget()).
+     *  Otherwise the last solution is returned. Default is 1e-6*/
+    void setBudgetTolerance(const double& eps){ _eps_budget = eps; }
+
+    /** Get the max. primal residual of the current iterate, so that it is returned if the time budget is exceeded*/
+    double getBudgetTolerance(){ return _eps_budget; }
+
 protected:
 
     std::shared_ptr<proxsuite::proxqp::dense::QP<double>> _solver_ptr;
 
     double _eps_abs = 1e-9;
+    double _eps_budget = 1e-6;
     int _n_iter;
     int _actual_n_iter;
 
     size_t _n_var_init; // number of variables in the configured solver instance
     size_t _n_eq_init;  // number of equalities in the configured solver instance
-    size_t _n_in_init;  // number of inequalities in the configured solver instance (inclusing bounds)
-
-    Eigen::MatrixXd _C_mtx; // inequalities matrix (including bounds)
-    Eigen::VectorXd _l_vec; // inequalities lower bounds
-    Eigen::VectorXd _u_vec; // inequalities upper bounds
+    size_t _n_in_init;  // number of inequalities in the configured solver instance (excluding bounds)
+    bool _bounded_init; // whether the configured solver instance has box constraints on the variables
 };
 
 }
@@ -235,3 +235,45 @@ BOOST_AUTO_TEST_CASE(solver_proxqp_bounded)
         BOOST_CHECK((qp.lower_x(j)-1e-9) <= solver_output(j) && solver_output(j) <= (qp.upper_x(j)+1e-9));
 
 }
+
+BOOST_AUTO_TEST_CASE(solver_proxqp_active_bounds)
+{
+    const int NO_JOINTS = 6;
+    const int NO_EQ_CONSTRAINTS = 0;
+    const int NO_IN_CONSTRAINTS = 1;
+    const bool WITH_BOUNDS = true;
+    const int NO_WSR = 200;
+
+    // Solve the problem min(||x-x_ref||) with active bound constraints and one inequality constraint. The bounds are passed to
+    // prox-qp as native box constraints, the result has to be the same as for x_ref clipped to the bounds
+
+    wbc::QuadraticProgram qp;
+    qp.resize(NO_JOINTS, NO_EQ_CONSTRAINTS, NO_IN_CONSTRAINTS, WITH_BOUNDS);
+
+    base::VectorXd x_ref(NO_JOINTS);
+    x_ref << 0.833, -0.096, 0.078, 0.971, -0.883, 0.366;
+
+    qp.H.setIdentity();
+    qp.g = -x_ref;
+    qp.lower_x.setConstant(-0.5);
+    qp.upper_x.setConstant(0.5);
+    // Inactive inequality constraint
+    qp.C.setOnes();
+    qp.lower_y.setConstant(-10);
+    qp.upper_y.setConstant(10);
+
+    qp.check();
+    wbc::HierarchicalQP hqp;
+    hqp << qp;
+
+    ProxQPSolver solver;
+    solver.setMaxNIter(NO_WSR);
+
+    base::VectorXd solver_output;
+    // Solve twice to test the warm started update of the box constraints
+    for(int i = 0; i < 2; i++){
+        BOOST_CHECK_NO_THROW(solver.solve(hqp, solver_output));
+        for(uint j = 0; j < NO_JOINTS; ++j)
+            BOOST_CHECK(fabs(solver_output(j) - std::min(std::max(x_ref(j), qp.lower_x(j)), qp.upper_x(j))) < 1e-6);
+    }
+}
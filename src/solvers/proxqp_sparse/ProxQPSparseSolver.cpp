@@ -0,0 +1,179 @@
+#include "ProxQPSparseSolver.hpp"
+#include "../../core/QuadraticProgram.hpp"
+#include <vector>
+
+#include <proxsuite/proxqp/sparse/sparse.hpp>
+#include <proxsuite/proxqp/status.hpp>
+
+namespace wbc {
+
+QPSolverRegistry<ProxQPSparseSolver> ProxQPSparseSolver::reg("proxqp_sparse");
+
+ProxQPSparseSolver::ProxQPSparseSolver()
+{
+    _n_iter = 10000;
+    _eps_abs = 1e-9;
+    _eps_budget = 1e-6;
+    _actual_n_iter = 0;
+    _n_pattern_updates = 0;
+}
+
+bool ProxQPSparseSolver::updateValues(const base::MatrixXd& dense, uint row_offset, SparseMatrix& sparse){
+    // If less nonzero values are copied into the pattern than the dense matrix contains, there are nonzero entries outside of the pattern
+    Eigen::Index n_copied = 0;
+    for(int col = 0; col < sparse.outerSize(); col++){
+        for(SparseMatrix::InnerIterator it(sparse, col); it; ++it){
+            const int row = it.row() - row_offset;
+            if(row >= 0 && row < dense.rows()){
+                it.valueRef() = dense(row, col);
+                n_copied += (it.value() != 0);
+            }
+        }
+    }
+    return n_copied == (dense.array() != 0).count();
+}
+
+void ProxQPSparseSolver::updatePattern(const base::MatrixXd& dense, uint row_offset, SparseMatrix& sparse){
+    // Keep all entries of the old pattern, so that entries that are only temporarily zero do not lead to repeated pattern updates
+    std::vector<Eigen::Triplet<double,int>> triplets;
+    triplets.reserve(sparse.nonZeros() + (dense.array() != 0).count());
+    for(int col = 0; col < sparse.outerSize(); col++){
+        for(SparseMatrix::InnerIterator it(sparse, col); it; ++it){
+            const int row = it.row() - row_offset;
+            if(row < 0 || row >= dense.rows())
+                triplets.emplace_back(it.row(), col, it.value());
+            else
+                triplets.emplace_back(it.row(), col, 0);
+        }
+    }
+    for(int col = 0; col < dense.cols(); col++)
+        for(int row = 0; row < dense.rows(); row++)
+            if(dense(row, col) != 0)
+                triplets.emplace_back(row + row_offset, col, dense(row, col));
+    // Duplicates are summed up. All entries of the old pattern within the dense block are zero, so the result is the dense value
+    sparse.setFromTriplets(triplets.begin(), triplets.end());
+}
+
+/// solve problem:
+/// min  0.5 * x'Hx + g'x
+/// s.t. Ax = b
+///      l < Cx < u 
+///      lb < x < ub
+void ProxQPSparseSolver::solve(const wbc::HierarchicalQP& hierarchical_qp, base::VectorXd& solver_output)
+{
+    namespace pqp = proxsuite::proxqp;
+
+    SolveTimer timer(stats);
+
+    if(hierarchical_qp.size() != 1)
+        throw std::runtime_error("ProxQPSparseSolver::solve: Constraints vector size must be 1 for the current implementation");
+
+    const wbc::QuadraticProgram &qp = hierarchical_qp[0];
+    qp.check();
+
+    size_t n_var = qp.nq;
+    size_t n_eq = qp.neq;
+    size_t n_in = qp.nin;
+    size_t n_bounds = qp.bounded ? n_var : 0;
+
+    bool pattern_changed = false;
+    if(!configured)
+    {
+        _n_var_init = n_var;
+        _n_eq_init = n_eq;
+        _n_in_init = n_in;
+        _bounded_init = qp.bounded;
+
+        _H.resize(n_var, n_var);
+        _A.resize(n_eq, n_var);
+        _C.resize(n_in + n_bounds, n_var);
+        _l_vec.resize(n_in + n_bounds);
+        _u_vec.resize(n_in + n_bounds);
+
+        // The bounds are a constant identity block in the bottom rows of C
+        if(qp.bounded){
+            std::vector<Eigen::Triplet<double,int>> triplets;
+            for(size_t i = 0; i < n_var; i++)
+                triplets.emplace_back(n_in + i, i, 1.0);
+            _C.setFromTriplets(triplets.begin(), triplets.end());
+        }
+        pattern_changed = true;
+    }
+    else if(n_var != _n_var_init || n_eq != _n_eq_init || n_in != _n_in_init || qp.bounded != _bounded_init)
+        throw std::runtime_error("QP problem changed dynamically. Not supported at the moment.");
+
+    // Copy only the values into the fixed sparsity pattern. Extend the pattern if required
+    if(pattern_changed || !updateValues(qp.H, 0, _H)){
+        updatePattern(qp.H, 0, _H);
+        pattern_changed = true;
+    }
+    if(pattern_changed || !updateValues(qp.A, 0, _A)){
+        updatePattern(qp.A, 0, _A);
+        pattern_changed = true;
+    }
+    if(pattern_changed || !updateValues(qp.C, 0, _C)){
+        updatePattern(qp.C, 0, _C);
+        pattern_changed = true;
+    }
+    _l_vec.head(n_in) = qp.lower_y;
+    _u_vec.head(n_in) = qp.upper_y;
+    if(qp.bounded){
+        _l_vec.tail(n_bounds) = qp.lower_x;
+        _u_vec.tail(n_bounds) = qp.upper_x;
+    }
+
+    if(pattern_changed)
+    {
+        _solver_ptr = std::make_shared<pqp::sparse::QP<double,int>>(_H.cast<bool>(), _A.cast<bool>(), _C.cast<bool>());
+        _solver_ptr->settings.eps_abs = _eps_abs;
+        _solver_ptr->settings.max_iter = _n_iter;
+        _solver_ptr->init(_H, qp.g, _A, qp.b, _C, _l_vec, _u_vec);
+        _n_pattern_updates++;
+        configured = true;
+    }
+    else
+    {
+        _solver_ptr->settings.initial_guess = pqp::InitialGuessStatus::WARM_START_WITH_PREVIOUS_RESULT;
+        _solver_ptr->update(_H, qp.g, _A, qp.b, _C, _l_vec, _u_vec);
+    }
+
+    // Limit the number of iterations according to the time budget
+    _solver_ptr->settings.max_iter = budgetedMaxIter(_n_iter);
+    _solver_ptr->solve();
+
+    solver_output.resize(qp.nq);
+    solver_output = _solver_ptr->results.x;
+
+    auto status = _solver_ptr->results.info.status;
+
+    _actual_n_iter = _solver_ptr->results.info.iter;
+    stats.n_iter = _actual_n_iter;
+    stats.n_active = (_solver_ptr->results.z.array() != 0).count();
+    stats.primal_residual = _solver_ptr->results.info.pri_res;
+    stats.dual_residual = _solver_ptr->results.info.dua_res;
+    stats.status = (int)status;
+    updateTimePerIteration(timer.elapsed(), _actual_n_iter);
+
+    // If the iterations have been limited due to the time budget, do not throw. Return the current iterate only if it satisfies the constraints
+    // up to the budget tolerance, otherwise the last solution, if available
+    if(status == pqp::QPSolverOutput::PROXQP_MAX_ITER_REACHED && _solver_ptr->settings.max_iter < _n_iter){
+        stats.budget_exceeded = true;
+        if(_solver_ptr->results.info.pri_res <= _eps_budget)
+            return;
+        if(last_solution.size() == qp.nq){
+            solver_output = last_solution;
+            return;
+        }
+        throw std::runtime_error("ProxQP returned error status: time budget exceeded and no feasible solution available.");
+    }
+    if(status == pqp::QPSolverOutput::PROXQP_MAX_ITER_REACHED)
+        throw std::runtime_error("ProxQP returned error status: max iterations reached.");
+    if(status == pqp::QPSolverOutput::PROXQP_PRIMAL_INFEASIBLE)
+        throw std::runtime_error("ProxQP returned error status: problem is primal infeasible.");
+    if(status == pqp::QPSolverOutput::PROXQP_DUAL_INFEASIBLE)
+        throw std::runtime_error("ProxQP returned error status: problem is dual infeasible.");
+
+    last_solution = solver_output;
+}
+
+} // namespace wbc
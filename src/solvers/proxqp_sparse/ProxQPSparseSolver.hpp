@@ -0,0 +1,106 @@
+#ifndef WBC_SOLVERS_PROXQP_SPARSE_SOLVER_HPP
+#define WBC_SOLVERS_PROXQP_SPARSE_SOLVER_HPP
+
+#include "../../core/QPSolver.hpp"
+
+#include <memory>
+
+#include <base/Eigen.hpp>
+#include <Eigen/SparseCore>
+
+#include <proxsuite/proxqp/sparse/wrapper.hpp>
+
+namespace wbc {
+
+class HierarchicalQP;
+
+/**
+ * @brief The ProxQPSparseSolver class is a wrapper for the sparse backend of the qp-solver prox-qp (see https://github.com/Simple-Robotics/proxsuite).
+ *  It solves problems of shape:
+ *  \f[
+ *        \begin{array}{ccc}
+ *        min(\mathbf{x}) & \frac{1}{2} \mathbf{x}^T\mathbf{H}\mathbf{x}+\mathbf{x}^T\mathbf{g}& \\
+ *             & & \\
+ *        s.t. & \mathbf{Ax} = \mathbf{b}& \\
+ *             & \mathbf{l} \leq \mathbf{Cx} \leq \mathbf{u}& \\
+ *             & \mathbf{lb} \leq \mathbf{x} \leq \mathbf{ub}& \\
+ *        \end{array}
+ *  \f]
+ *
+ * This solver is meant for large problems with block sparse structure, e.g. the QP of the acceleration_tsid scene for floating base robots with many
+ * contacts. The sparsity pattern of H, A and C is taken from the nonzero entries of the first QP. In all subsequent calls only the values are copied
+ * into the fixed pattern and the solver is warm started. Since the sparse backend of prox-qp has no box constraints, the variable bounds are added
+ * to C as a sparse identity block. If an entry outside of the current pattern becomes nonzero (e.g. a Jacobian entry that was zero in the initial
+ * configuration), the pattern is extended and the solver is reinitialized, which is expensive, but happens only rarely.
+ */
+class ProxQPSparseSolver : public QPSolver{
+private:
+    static QPSolverRegistry<ProxQPSparseSolver> reg;
+
+public:
+    typedef Eigen::SparseMatrix<double, Eigen::ColMajor, int> SparseMatrix;
+
+    ProxQPSparseSolver();
+    virtual ~ProxQPSparseSolver() noexcept { };
+
+    /**
+     * @brief solve Solve the given quadratic program
+     * @param constraints Description of the hierarchical quadratic program to solve. Each vector entry correspond to a stage in the hierarchy where
+     *                    the first entry has the highest priority. Currently only one priority level is implemented.
+     * @param solver_output solution of the quadratic program
+     */
+    virtual void solve(const wbc::HierarchicalQP& hierarchical_qp, base::VectorXd& solver_output);
+
+    /** Set the maximum number of iterations*/
+    void setMaxNIter(const uint& n){ _n_iter = n; }
+
+    /** Get the maximum number of iterations*/
+    uint getMaxNIter(){ return _n_iter; }
+
+    /** Get number of iterations actually performed*/
+    int getNter(){ return _actual_n_iter; }
+
+    /** Set the max. primal residual of the current iterate, so that it is returned if the time budget is exceeded (see QPSolver::setTimeBudget()).
+     *  Otherwise the last solution is returned. Default is 1e-6*/
+    void setBudgetTolerance(const double& eps){ _eps_budget = eps; }
+
+    /** Get the max. primal residual of the current iterate, so that it is returned if the time budget is exceeded*/
+    double getBudgetTolerance(){ return _eps_budget; }
+
+    /** Get number of times the sparsity pattern has been (re-)computed, including the initial configuration*/
+    uint getNoPatternUpdates(){ return _n_pattern_updates; }
+
+    /** Get the current sparse Hessian, constraint matrix and inequality matrix (including bounds)*/
+    const SparseMatrix& getH(){ return _H; }
+    const SparseMatrix& getA(){ return _A; }
+    const SparseMatrix& getC(){ return _C; }
+
+protected:
+    /** Copy the values of the dense matrix into the fixed sparsity pattern. Return false if the dense matrix has nonzero entries outside of the pattern*/
+    static bool updateValues(const base::MatrixXd& dense, uint row_offset, SparseMatrix& sparse);
+    /** Extend the sparsity pattern by the nonzero entries of the given dense matrix and copy its values*/
+    static void updatePattern(const base::MatrixXd& dense, uint row_offset, SparseMatrix& sparse);
+
+    std::shared_ptr<proxsuite::proxqp::sparse::QP<double,int>> _solver_ptr;
+
+    double _eps_abs = 1e-9;
+    double _eps_budget = 1e-6;
+    int _n_iter;
+    int _actual_n_iter;
+    uint _n_pattern_updates;
+
+    size_t _n_var_init; // number of variables in the configured solver instance
+    size_t _n_eq_init;  // number of equalities in the configured solver instance
+    size_t _n_in_init;  // number of inequalities in the configured solver instance (excluding bounds)
+    bool _bounded_init; // whether the configured solver instance has bounds on the variables
+
+    SparseMatrix _H;        // Hessian
+    SparseMatrix _A;        // equality constraint matrix
+    SparseMatrix _C;        // inequality constraint matrix (including bounds as identity block)
+    Eigen::VectorXd _l_vec; // inequalities lower bounds
+    Eigen::VectorXd _u_vec; // inequalities upper bounds
+};
+
+}
+
+#endif
@@ -0,0 +1,111 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+#include <iostream>
+#include "../../../core/QuadraticProgram.hpp"
+#include "../ProxQPSparseSolver.hpp"
+
+using namespace wbc;
+using namespace std;
+
+BOOST_AUTO_TEST_CASE(solver_proxqp_sparse_with_constraints)
+{
+    const int NO_JOINTS = 6;
+    const int NO_EQ_CONSTRAINTS = 2;
+    const int NO_IN_CONSTRAINTS = 2;
+    const bool WITH_BOUNDS = true;
+    const int NO_WSR = 1000;
+
+    // Solve the problem min(||x||), subject to sparse equality, inequality and bound constraints
+
+    wbc::QuadraticProgram qp;
+    qp.resize(NO_JOINTS, NO_EQ_CONSTRAINTS, NO_IN_CONSTRAINTS, WITH_BOUNDS);
+
+    qp.H.setIdentity();
+    qp.g.setZero();
+    qp.A << 1, 1, 0, 0, 0, 0,
+            0, 0, 1, 0, 0, 1;
+    qp.b << 1.0, -0.5;
+    qp.C << 0, 0, 0, 1, 0, 0,
+            0, 0, 0, 0, 1, 0;
+    qp.lower_y << 0.2, -10;
+    qp.upper_y << 10, -0.3;
+    qp.lower_x.setConstant(-0.4);
+    qp.upper_x.setConstant(0.6);
+
+    qp.check();
+    wbc::HierarchicalQP hqp;
+    hqp << qp;
+
+    ProxQPSparseSolver solver;
+    solver.setMaxNIter(NO_WSR);
+    BOOST_CHECK(solver.getMaxNIter() == NO_WSR);
+
+    base::VectorXd solver_output;
+    BOOST_CHECK_NO_THROW(solver.solve(hqp, solver_output));
+
+    base::VectorXd expected(NO_JOINTS);
+    expected << 0.5, 0.5, -0.25, 0.2, -0.3, -0.25;
+    for(uint j = 0; j < NO_JOINTS; ++j)
+        BOOST_CHECK(fabs(solver_output(j) - expected(j)) < 1e-6);
+
+    // The sparsity pattern contains only the nonzero entries of H, A, C and the identity block of the bounds
+    BOOST_CHECK(solver.getNoPatternUpdates() == 1);
+    BOOST_CHECK(solver.getH().nonZeros() == NO_JOINTS);
+    BOOST_CHECK(solver.getA().nonZeros() == 4);
+    BOOST_CHECK(solver.getC().nonZeros() == 2 + NO_JOINTS);
+}
+
+BOOST_AUTO_TEST_CASE(solver_proxqp_sparse_pattern_update)
+{
+    const int NO_JOINTS = 4;
+    const int NO_EQ_CONSTRAINTS = 1;
+    const int NO_IN_CONSTRAINTS = 0;
+    const bool WITH_BOUNDS = false;
+
+    // Solve the problem min(||x||), subject to Ax=b, where the nonzero entries of A change between the calls
+
+    wbc::QuadraticProgram qp;
+    qp.resize(NO_JOINTS, NO_EQ_CONSTRAINTS, NO_IN_CONSTRAINTS, WITH_BOUNDS);
+    qp.H.setIdentity();
+    qp.g.setZero();
+    qp.A << 1, 0, 0, 0;
+    qp.b << 1;
+
+    wbc::HierarchicalQP hqp;
+    hqp << qp;
+
+    ProxQPSparseSolver solver;
+    base::VectorXd solver_output;
+
+    // Only values change: Pattern is kept
+    BOOST_CHECK_NO_THROW(solver.solve(hqp, solver_output));
+    hqp[0].b << 2;
+    BOOST_CHECK_NO_THROW(solver.solve(hqp, solver_output));
+    BOOST_CHECK(solver.getNoPatternUpdates() == 1);
+    BOOST_CHECK(fabs(solver_output(0) - 2) < 1e-6);
+
+    // New nonzero entry: Pattern is extended
+    hqp[0].A << 1, 1, 0, 0;
+    BOOST_CHECK_NO_THROW(solver.solve(hqp, solver_output));
+    BOOST_CHECK(solver.getNoPatternUpdates() == 2);
+    BOOST_CHECK(solver.getA().nonZeros() == 2);
+    BOOST_CHECK(fabs(solver_output(0) - 1) < 1e-6 && fabs(solver_output(1) - 1) < 1e-6);
+
+    // Entry becomes zero again: Pattern is kept
+    hqp[0].A << 0, 1, 0, 0;
+    BOOST_CHECK_NO_THROW(solver.solve(hqp, solver_output));
+    BOOST_CHECK(solver.getNoPatternUpdates() == 2);
+    BOOST_CHECK(fabs(solver_output(0)) < 1e-6 && fabs(solver_output(1) - 2) < 1e-6);
+
+    // Change of the problem size is not supported
+    wbc::QuadraticProgram qp2;
+    qp2.resize(NO_JOINTS, NO_EQ_CONSTRAINTS+1, NO_IN_CONSTRAINTS, WITH_BOUNDS);
+    qp2.H.setIdentity();
+    qp2.g.setZero();
+    qp2.A.setIdentity();
+    qp2.b.setZero();
+    wbc::HierarchicalQP hqp2;
+    hqp2 << qp2;
+    BOOST_CHECK_THROW(solver.solve(hqp2, solver_output), std::runtime_error);
+}
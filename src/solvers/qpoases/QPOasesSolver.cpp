@@ -12,6 +12,7 @@ QPSolverRegistry<QPOASESSolver> QPOASESSolver::reg("qpoases");
 
 QPOASESSolver::QPOASESSolver(){
     n_wsr = 1000;
+    budget_tolerance = 1e-6;
     options.setToFast();
     options.printLevel = PL_NONE;
 }
@@ -22,34 +23,42 @@ QPOASESSolver::~QPOASESSolver(){
 
 void QPOASESSolver::solve(const wbc::HierarchicalQP &hierarchical_qp, base::VectorXd &solver_output){
 
+    SolveTimer timer(stats);
+
     if(hierarchical_qp.size() != 1)
         throw std::runtime_error("QPOASESSolver::solve: Number of task hierarchies must be 1 for the current implementation");
 
     const wbc::QuadraticProgram &qp = hierarchical_qp[0];
     qp.check();
 
-    size_t nc = qp.C.rows() + qp.A.rows();
+    size_t nc = qp.neq + qp.nin;
 
     if(!configured){
-        sq_problem = SQProblem(qp.A.cols(), nc);
+        sq_problem = SQProblem(qp.nq, nc);
         sq_problem.setOptions(options);
         configured = true;
     }
 
-    // Have to convert to row-major order matrices. Eigen uses column major by default and
-    // qpoases expects the data to be arranged in row-major
-    H = qp.H;
-
-    // same for A mtx but equalities and inequalities constraints have to be merged in a single matrix
-    A.resize(nc, qp.A.cols());
-    A.topRows(qp.A.rows()) = qp.A;
-    A.bottomRows(qp.C.rows()) = qp.C;
-
-    // create constraints vectors (merging equalities and inequalities vecs)
-    Eigen::VectorXd lower_a(nc);
-    Eigen::VectorXd upper_a(nc);
-    lower_a << qp.b, qp.lower_y;
-    upper_a << qp.b, qp.upper_y;
+    // qpOASES expects row-major matrices. The Hessian is symmetric, so its column-major data can be used as is. The constraints can be passed
+    // without copy if the scene has written them to the row-major staging buffer of the QP. Otherwise equalities and inequalities have to be
+    // merged into a single row-major matrix
+    const real_t* A_data = qp.staged_constraints.data();
+    const real_t* lower_a_data = qp.staged_lower.data();
+    const real_t* upper_a_data = qp.staged_upper.data();
+    if(!qp.staged){
+        A.resize(nc, qp.nq);
+        A.topRows(qp.neq) = qp.A;
+        A.bottomRows(qp.nin) = qp.C;
+
+        lower_a.resize(nc);
+        upper_a.resize(nc);
+        lower_a << qp.b, qp.lower_y;
+        upper_a << qp.b, qp.upper_y;
+
+        A_data = A.data();
+        lower_a_data = lower_a.data();
+        upper_a_data = upper_a.data();
+    }
 
     // Joint space upper and lower bounds
     real_t* lb_ptr = 0;
@@ -62,43 +71,75 @@ void QPOASESSolver::solve(const wbc::HierarchicalQP &hierarchical_qp, base::Vect
     // Constraint space upper and lower bounds
     real_t* lbA_ptr = 0;
     real_t* ubA_ptr = 0;
-    if(lower_a.size() > 0)
-        lbA_ptr = (real_t*)lower_a.data();
-    if(upper_a.size() > 0)
-         ubA_ptr = (real_t*)upper_a.data();
+    if(nc > 0){
+        lbA_ptr = (real_t*)lower_a_data;
+        ubA_ptr = (real_t*)upper_a_data;
+    }
 
     // Constraint matrix
-    real_t* A_ptr = A.data();
+    real_t* A_ptr = (real_t*)A_data;
 
     // Hessian matrix:
-    real_t* H_ptr = (real_t*)H.data();
+    real_t* H_ptr = (real_t*)qp.H.data();
 
     // Gradient vector
     real_t* g_ptr = 0;
     if(qp.g.size() > 0)
         g_ptr = (real_t*)qp.g.data();
 
+    // Time budget: qpOASES stops the homotopy if the given time is exceeded and writes the actually used time back
+    real_t cputime = time_budget;
+    real_t* cputime_ptr = time_budget > 0 ? &cputime : 0;
+
     actual_n_wsr = n_wsr;
-    if(!sq_problem.isInitialised()){
-        ret_val = sq_problem.init(H_ptr, g_ptr, A_ptr, lb_ptr, ub_ptr, lbA_ptr, ubA_ptr, actual_n_wsr, 0);
-        if(ret_val != SUCCESSFUL_RETURN){
-            options.print();
-            qp.print();
+    const bool init = !sq_problem.isInitialised();
+    if(init)
+        ret_val = sq_problem.init(H_ptr, g_ptr, A_ptr, lb_ptr, ub_ptr, lbA_ptr, ubA_ptr, actual_n_wsr, cputime_ptr);
+    else
+        ret_val = sq_problem.hotstart(H_ptr, g_ptr, A_ptr, lb_ptr, ub_ptr, lbA_ptr, ubA_ptr, actual_n_wsr, cputime_ptr);
+    stats.status = ret_val;
+    stats.n_iter = actual_n_wsr;
+    stats.budget_exceeded = ret_val != SUCCESSFUL_RETURN && time_budget > 0 && cputime >= time_budget;
+    if(ret_val != SUCCESSFUL_RETURN && !stats.budget_exceeded){
+        options.print();
+        qp.print();
+        if(init)
             throw std::runtime_error("SQ Problem initialization failed with error " + std::to_string(ret_val));
-        }
-    }
-    else{
-        ret_val = sq_problem.hotstart(H_ptr, g_ptr, A_ptr, lb_ptr, ub_ptr, lbA_ptr, ubA_ptr, actual_n_wsr, 0);
-        if(ret_val != SUCCESSFUL_RETURN){
-            options.print();
-            qp.print();
+        else
             throw std::runtime_error("SQ Problem hotstart failed with error " + std::to_string(ret_val));
-        }
     }
 
+    // If the time budget is exceeded, the primal solution is the solution of the last intermediate QP of the homotopy, which is only feasible
+    // w.r.t. the bounds and constraints of that intermediate QP. Use it only if it satisfies the current bounds and constraints up to the budget
+    // tolerance, otherwise use the last solution
     solver_output.resize(qp.nq);
-    if(sq_problem.getPrimalSolution( solver_output.data() ) == RET_QP_NOT_SOLVED)
+    const bool solved = sq_problem.getPrimalSolution( solver_output.data() ) != RET_QP_NOT_SOLVED;
+    if(!solved && !stats.budget_exceeded)
         throw std::runtime_error("SQ Problem getPrimalSolution() returned " + std::to_string(RET_QP_NOT_SOLVED));
+    if(stats.budget_exceeded && (!solved || qp.primalResidual(solver_output) > budget_tolerance)){
+        if(last_solution.size() != qp.nq)
+            throw std::runtime_error("SQ Problem: Time budget exceeded and no feasible solution available");
+        solver_output = last_solution;
+        stats.primal_residual = qp.primalResidual(solver_output);
+        return;
+    }
+    if(!stats.budget_exceeded)
+        last_solution = solver_output;
+
+    // Solver stats. Stationarity of the Lagrangian in qpOASES convention: H*x + g - y_bounds - A^T*y_constraints = 0
+    // Equality constraints are always in the active set of qpOASES
+    stats.n_active = sq_problem.getNAC() - qp.neq + qp.nq - sq_problem.getNFR();
+    stats.primal_residual = qp.primalResidual(solver_output);
+    dual_solution.resize(qp.nq + nc);
+    sq_problem.getDualSolution(dual_solution.data());
+    lagrangian_gradient.resize(qp.nq);
+    lagrangian_gradient.noalias() = qp.H * solver_output;
+    if(qp.g.size() > 0)
+        lagrangian_gradient += qp.g;
+    lagrangian_gradient -= dual_solution.head(qp.nq);
+    if(nc > 0)
+        lagrangian_gradient.noalias() -= Eigen::Map<const Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> >(A_data, nc, qp.nq).transpose() * dual_solution.tail(nc);
+    stats.dual_residual = lagrangian_gradient.cwiseAbs().maxCoeff();
 }
 
 returnValue QPOASESSolver::getReturnValue(){
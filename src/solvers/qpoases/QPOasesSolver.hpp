@@ -55,14 +55,24 @@ public:
     void setOptionsPreset(const qpOASES::optionPresets& opt);
     /** Get Quadratic program*/
     const qpOASES::SQProblem& getSQProblem(){return sq_problem;}
+    /** Set the max. violation of the bounds and constraints by the intermediate homotopy solution, so that it is returned if the time budget is exceeded
+     *  (see QPSolver::setTimeBudget()). Otherwise the last solution is returned. Default is 1e-6*/
+    void setBudgetTolerance(double tol){budget_tolerance = tol;}
+    /** Get the max. violation of the bounds and constraints by the intermediate homotopy solution, so that it is returned if the time budget is exceeded*/
+    double getBudgetTolerance(){return budget_tolerance;}
+    /** qpOASES expects the constraints in row-major order, so they can be passed without copy if the QP is staged*/
+    virtual bool constraintStaging() const {return true;}
 
 protected:
     qpOASES::Options options;
     qpOASES::SQProblem sq_problem;
     int n_wsr, actual_n_wsr;
+    double budget_tolerance;
     qpOASES::returnValue ret_val;
-    Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> H;
-    Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> A;
+    Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> A; /** Stacked constraint matrix, only used if the QP is not staged*/
+    Eigen::VectorXd lower_a, upper_a;                                          /** Stacked constraint bounds, only used if the QP is not staged*/
+    Eigen::VectorXd dual_solution;                                             /** Dual solution, first bounds, then constraints*/
+    Eigen::VectorXd lagrangian_gradient;                                       /** Gradient of the Lagrangian at the solution, for the solver stats*/
     base::Time stamp;
 };
 
@@ -283,3 +283,69 @@ BOOST_AUTO_TEST_CASE(solver_qpoases_bounded)
         BOOST_CHECK((qp.lower_x(j)-1e-9) <= solver_output(j) && solver_output(j) <= (qp.upper_x(j)+1e-9));
 
 }
+
+BOOST_AUTO_TEST_CASE(solver_qpoases_staged_constraints)
+{
+    // The same QP with equality and inequality constraints, once built in staged form (constraints in the row-major staging buffer)
+    // and once in regular form, must give the same solution
+
+    const int NO_JOINTS = 6;
+    const int NO_EQ_CONSTRAINTS = 2;
+    const int NO_IN_CONSTRAINTS = 3;
+    const bool WITH_BOUNDS = true;
+
+    base::MatrixXd A_eq(NO_EQ_CONSTRAINTS, NO_JOINTS), A_in(NO_IN_CONSTRAINTS, NO_JOINTS);
+    A_eq << 0.642, 0.706, 0.565,  0.48,  0.59, 0.917,
+            0.553, 0.087,  0.43,  0.71, 0.148,  0.87;
+    A_in << 0.249, 0.632, 0.711,  0.13, 0.426, 0.963,
+            0.682, 0.123, 0.998, 0.716, 0.961, 0.901,
+            0.891, 0.019, 0.716, 0.534, 0.725, 0.633;
+    base::VectorXd b_eq(NO_EQ_CONSTRAINTS), lower(NO_IN_CONSTRAINTS), upper(NO_IN_CONSTRAINTS);
+    b_eq << 0.833, 0.096;
+    lower << 0.078, -1.0, 0.1;
+    upper << 0.2, 0.0, 0.3;
+
+    QPOASESSolver solver;
+    BOOST_CHECK(solver.constraintStaging());
+
+    base::VectorXd solver_output[2];
+    for(int staged = 0; staged < 2; staged++){
+        wbc::QuadraticProgram qp;
+        qp.resize(NO_JOINTS, NO_EQ_CONSTRAINTS, NO_IN_CONSTRAINTS, WITH_BOUNDS, staged);
+        BOOST_CHECK(qp.staged == (bool)staged);
+        BOOST_CHECK(qp.A.rows() == (staged ? 0 : NO_EQ_CONSTRAINTS));
+        BOOST_CHECK(qp.staged_constraints.rows() == (staged ? NO_EQ_CONSTRAINTS + NO_IN_CONSTRAINTS : 0));
+
+        qp.H.setIdentity();
+        qp.g.setZero();
+        qp.lower_x.setConstant(-10);
+        qp.upper_x.setConstant(10);
+        qp.setEqualityConstraints(0, A_eq, b_eq);
+        qp.setInequalityConstraints(0, A_in.topRows(1), lower.head(1), upper.head(1));
+        qp.setInequalityConstraints(1, A_in.bottomRows(2), lower.tail(2), upper.tail(2));
+        qp.check();
+
+        wbc::HierarchicalQP hqp;
+        hqp << qp;
+
+        QPOASESSolver solver;
+        BOOST_CHECK_NO_THROW(solver.solve(hqp, solver_output[staged]));
+
+        base::VectorXd y_eq = A_eq*solver_output[staged];
+        base::VectorXd y_in = A_in*solver_output[staged];
+        for(int j = 0; j < NO_EQ_CONSTRAINTS; j++)
+            BOOST_CHECK(fabs(y_eq(j) - b_eq(j)) < 1e-9);
+        for(int j = 0; j < NO_IN_CONSTRAINTS; j++)
+            BOOST_CHECK(lower(j) - 1e-9 <= y_in(j) && y_in(j) <= upper(j) + 1e-9);
+
+        const SolverStats& stats = solver.getStats();
+        BOOST_CHECK(stats.status == qpOASES::SUCCESSFUL_RETURN);
+        BOOST_CHECK(stats.solve_time > 0);
+        BOOST_CHECK(stats.n_iter >= 0);
+        BOOST_CHECK(stats.n_active >= 0 && stats.n_active <= NO_IN_CONSTRAINTS + NO_JOINTS);
+        BOOST_CHECK(stats.primal_residual < 1e-9);
+        BOOST_CHECK(stats.dual_residual < 1e-9);
+    }
+    for(int j = 0; j < NO_JOINTS; j++)
+        BOOST_CHECK(fabs(solver_output[0](j) - solver_output[1](j)) < 1e-9);
+}
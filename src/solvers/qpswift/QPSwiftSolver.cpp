@@ -24,8 +24,8 @@ QPSwiftSolver::~QPSwiftSolver(){
 
 void QPSwiftSolver::toQpSwift(const wbc::QuadraticProgram &qp){
 
-    G.setZero();
-
+    // The buffers have been allocated in solve(), so that the assignments below do not allocate memory. The bounds
+    // part of the inequality constraint matrix is constant and has been set there as well
     P = qp.H;
     c = qp.g;
     A = qp.A;
@@ -38,12 +38,14 @@ void QPSwiftSolver::toQpSwift(const wbc::QuadraticProgram &qp){
     h.segment(qp.nin, qp.nin) = -qp.lower_y;
 
     if(qp.bounded){
-        G.middleRows(2*qp.nin, n_dec).diagonal().setConstant(1.0);        // map bounds as inequalities
-        G.middleRows(2*qp.nin+n_dec, n_dec).diagonal().setConstant(-1.0);
         h.segment(2*qp.nin, n_dec) = qp.upper_x;        // map bounds as inequalities
         h.segment(2*qp.nin+n_dec, n_dec) = -qp.lower_x;
     }
 
+    // QP_SETUP_dense copies the matrices into the sparse KKT structures of a new workspace, and qpSWIFT provides no means
+    // to update these in place. Release the previous workspace, otherwise a new one would be leaked in every cycle
+    if(my_qp)
+        QP_CLEANUP_dense(my_qp);
     my_qp = QP_SETUP_dense(n_dec,                   // Number decision variables
                            n_ineq,                  // Number inequality constraints
                            n_eq,                    // Number equality constraints
@@ -55,6 +57,8 @@ void QPSwiftSolver::toQpSwift(const wbc::QuadraticProgram &qp){
                            (double*)b.data(),       // Equality constraint vector
                            NULL,
                            COLUMN_MAJOR_ORDERING);
+    if(!my_qp)
+        throw std::runtime_error("QPSwiftSolver: QP_SETUP_dense failed");
 
     my_qp->options->maxit = max_iter;
     my_qp->options->reltol = rel_tol;
@@ -66,6 +70,8 @@ void QPSwiftSolver::toQpSwift(const wbc::QuadraticProgram &qp){
 
 void QPSwiftSolver::solve(const wbc::HierarchicalQP &hierarchical_qp, base::VectorXd &solver_output){
 
+    SolveTimer timer(stats);
+
     if(hierarchical_qp.size() != 1)
         throw std::runtime_error("QPSwiftSolver::solve: Number of task hierarchies must be 1 for the current implementation");
 
@@ -79,11 +85,16 @@ void QPSwiftSolver::solve(const wbc::HierarchicalQP &hierarchical_qp, base::Vect
 
         A.resize(n_eq, n_dec);
         b.resize(n_eq);
-        G.resize(n_ineq, n_dec);
+        G.setZero(n_ineq, n_dec);
         h.resize(n_ineq);
         P.resize(n_dec, n_dec);
         c.resize(n_dec);
-        solver_output.resize(n_dec);
+
+        // Bounds are mapped as inequalities, the corresponding part of G is constant
+        if(qp.bounded){
+            G.middleRows(2*qp.nin, n_dec).diagonal().setConstant(1.0);
+            G.middleRows(2*qp.nin+n_dec, n_dec).diagonal().setConstant(-1.0);
+        }
 
         LOG_DEBUG_S << "n_dec:    " << n_dec    << std::endl;
         LOG_DEBUG_S << "n_eq:     " << n_eq     << std::endl;
@@ -93,7 +104,13 @@ void QPSwiftSolver::solve(const wbc::HierarchicalQP &hierarchical_qp, base::Vect
 
     toQpSwift(qp);
 
+    // Limit the number of iterations according to the time budget
+    my_qp->options->maxit = budgetedMaxIter((int)max_iter);
+
     qp_int exit_code = QP_SOLVE(my_qp);
+    stats.status = exit_code;
+    stats.n_iter = my_qp->stats->IterationCount;
+    updateTimePerIteration(timer.elapsed(), stats.n_iter);
 
     switch(exit_code){
     case QP_OPTIMAL:{
@@ -111,6 +128,15 @@ void QPSwiftSolver::solve(const wbc::HierarchicalQP &hierarchical_qp, base::Vect
         LOG_DEBUG_S << "LDL Time       : " << my_qp->stats->ldl_numeric * 1000.0 << " ms" << std::endl;
         LOG_DEBUG_S << "Diff	       : " << (my_qp->stats->kkt_time - my_qp->stats->ldl_numeric) * 1000.0 << " ms" << std::endl;
         LOG_DEBUG_S << "Iterations     : " << my_qp->stats->IterationCount << std::endl;
+        // If the iterations have been limited due to the time budget, do not throw. The iterates of the interior point method are not
+        // feasible in general, so return the last solution. Throw if there is none
+        if((uint)my_qp->options->maxit < max_iter){
+            stats.budget_exceeded = true;
+            if(last_solution.size() != n_dec)
+                throw std::runtime_error("QPSwiftSolver failed: Time budget exceeded and no feasible solution available");
+            solver_output = last_solution;
+            return;
+        }
         throw std::runtime_error("QPSwiftSolver failed: Maximum Iterations reached");
     }
     case QP_FATAL:{
@@ -121,8 +147,11 @@ void QPSwiftSolver::solve(const wbc::HierarchicalQP &hierarchical_qp, base::Vect
     }
     }
 
+    solver_output.resize(n_dec);
     for(int i = 0; i < n_dec; i++)
         solver_output[i] = my_qp->x[i];
+    stats.primal_residual = qp.primalResidual(solver_output);
+    last_solution = solver_output;
 }
 
 }
@@ -4,7 +4,9 @@
 namespace wbc {
 
 CartesianTask::CartesianTask(const TaskConfig &_config, uint n_robot_joints) :
-    Task(_config, n_robot_joints){
+    Task(_config, n_robot_joints),
+    chain_handle(-1),
+    ref_frame_handle(-1){
 
 }
 
@@ -12,4 +14,13 @@ CartesianTask::~CartesianTask(){
 
 }
 
+void CartesianTask::registerChains(RobotModelPtr robot_model){
+    if(chain_handle < 0){
+        chain_handle = robot_model->registerChain(config.root, config.tip);
+        setActiveColumns(robot_model->chainJointIndices(chain_handle));
+    }
+    if(ref_frame_handle < 0)
+        ref_frame_handle = robot_model->registerChain(config.root, config.ref_frame);
+}
+
 } //namespace wbc
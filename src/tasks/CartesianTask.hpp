@@ -19,6 +19,19 @@ public:
      * @brief Update the Cartesian reference input for this task.
      */
     virtual void setReference(const base::samples::RigidBodyStateSE3& ref) = 0;
+
+protected:
+    /**
+     * @brief Register the kinematic chains root->tip and root->ref_frame with the robot model and set the active columns of the task matrix to
+     *  the joints of the chain root->tip. Does nothing if this has already been done.
+     */
+    void registerChains(RobotModelPtr robot_model);
+
+    /** Handle of the kinematic chain root->tip in the robot model. -1 if not registered yet*/
+    int chain_handle;
+
+    /** Handle of the kinematic chain root->ref_frame in the robot model. -1 if not registered yet*/
+    int ref_frame_handle;
 };
 
 } //namespace wbc
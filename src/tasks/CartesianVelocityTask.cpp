@@ -9,19 +9,20 @@ CartesianVelocityTask::CartesianVelocityTask(TaskConfig config, uint n_robot_joi
 }
 
 void CartesianVelocityTask::update(RobotModelPtr robot_model){
-    
+    registerChains(robot_model);
+
     // Task Jacobian
-    A = robot_model->spaceJacobian(config.root, config.tip);
+    A = robot_model->spaceJacobian(chain_handle);
 
     // Convert task twist to robot root
-    base::MatrixXd rot_mat = robot_model->rigidBodyState(config.root, config.ref_frame).pose.orientation.toRotationMatrix();
-    y_ref_root.segment(0,3) = rot_mat * y_ref.segment(0,3);
-    y_ref_root.segment(3,3) = rot_mat * y_ref.segment(3,3);
+    base::Matrix3d rot_mat = robot_model->rigidBodyState(ref_frame_handle).pose.orientation.toRotationMatrix();
+    y_ref_root.segment<3>(0) = rot_mat * y_ref.segment<3>(0);
+    y_ref_root.segment<3>(3) = rot_mat * y_ref.segment<3>(3);
 
     // Also convert the weight vector from ref frame to the root frame. Take the absolute values after rotation, since weights can only
     // assume positive values
-    weights_root.segment(0,3) = rot_mat * weights.segment(0,3);
-    weights_root.segment(3,3) = rot_mat * weights.segment(3,3);
+    weights_root.segment<3>(0) = rot_mat * weights.segment<3>(0);
+    weights_root.segment<3>(3) = rot_mat * weights.segment<3>(3);
     weights_root = weights_root.cwiseAbs();
 }
 
@@ -11,4 +11,12 @@ JointTask::~JointTask(){
 
 }
 
+void JointTask::updateJointIndices(RobotModelPtr robot_model){
+    if(!joint_indices.empty())
+        return;
+    for(const std::string& name : config.joint_names)
+        joint_indices.push_back(robot_model->jointIndex(name));
+    setActiveColumns(joint_indices);
+}
+
 } //namespace wbc
@@ -18,6 +18,15 @@ public:
      */
     virtual void setReference(const base::commands::Joints& ref) = 0;
 
+protected:
+    /**
+     * @brief Look up the indices of the task joints in the joint vector of the robot model and set the active columns of the task matrix accordingly.
+     *  Does nothing if this has already been done.
+     */
+    void updateJointIndices(RobotModelPtr robot_model);
+
+    /** Index of each task joint in the joint vector of the robot model. Empty if not looked up yet*/
+    std::vector<uint> joint_indices;
 };
 
 } //namespace wbc
@@ -12,10 +12,10 @@ void JointVelocityTask::update(RobotModelPtr robot_model){
 
     // Joint space tasks: task matrix has only ones and Zeros. The joint order in the tasks might be different than in the robot model.
     // Thus, for joint space tasks, the joint indices have to be mapped correctly.
+    updateJointIndices(robot_model);
     for(uint k = 0; k < config.joint_names.size(); k++){
 
-        int idx = robot_model->jointIndex(config.joint_names[k]);
-        A(k,idx) = 1.0;
+        A(k,joint_indices[k]) = 1.0;
         y_ref_root = y_ref;     // In joint space y_ref is equal to y_ref_root
         weights_root = weights; // Same of the weights
     }
@@ -119,14 +119,20 @@ void URDFTools::printTree(const std::string& filename){
 
 }
 
-std::vector<std::string> URDFTools::addFloatingBaseToURDF(urdf::ModelInterfaceSharedPtr& robot_urdf, const std::string &world_frame_id){
-
-    std::vector<std::string> floating_base_names = {"floating_base_trans_x", "floating_base_trans_y", "floating_base_trans_z",
-                                                    "floating_base_rot_x", "floating_base_rot_y", "floating_base_rot_z"};
+std::string URDFTools::URDFToString(const urdf::ModelInterfaceSharedPtr& robot_urdf){
     TiXmlDocument *doc = urdf::exportURDF(robot_urdf);
     TiXmlPrinter printer;
     doc->Accept(&printer);
     std::string robot_xml_string = printer.CStr();
+    delete doc;
+    return robot_xml_string;
+}
+
+std::vector<std::string> URDFTools::addFloatingBaseToURDF(urdf::ModelInterfaceSharedPtr& robot_urdf, const std::string &world_frame_id){
+
+    std::vector<std::string> floating_base_names = {"floating_base_trans_x", "floating_base_trans_y", "floating_base_trans_z",
+                                                    "floating_base_rot_x", "floating_base_rot_y", "floating_base_rot_z"};
+    std::string robot_xml_string = URDFToString(robot_urdf);
     robot_xml_string.erase(robot_xml_string.find("</robot>"), std::string("</robot>").length());
     std::string floating_base = std::string("  <link name='" + world_frame_id + "'>\n")   +
             "    <inertial>" +
@@ -40,6 +40,9 @@ public:
     /** Create a 6 Dof virtual floating base URDF and add it to the robot model*/
     static std::vector<std::string> addFloatingBaseToURDF(urdf::ModelInterfaceSharedPtr& robot_urdf, const std::string &world_frame_id = "world");
 
+    /** Convert the given URDF model to an URDF (XML) string*/
+    static std::string URDFToString(const urdf::ModelInterfaceSharedPtr& robot_urdf);
+
     /** Set all blacklisted joints in robot model to fixed*/
     static bool applyJointBlacklist(urdf::ModelInterfaceSharedPtr& robot_urdf, const std::vector<std::string> &blacklist);
 };